@@ -0,0 +1,647 @@
+/**
+ * @file bench.cpp
+ *
+ * @brief Benchmark di bst a confronto con std::set
+ *
+ * Misura add, find (trovati e non trovati), visita completa, copia e subtree
+ * su chiavi int, char e team (con chiave stringa), per cinque carichi
+ * (casuale, ordinato, ordinato al contrario, con molti duplicati e casuale con
+ * ricerche sbilanciate secondo una distribuzione di Zipf) e dimensioni
+ * da 10^3 a 10^max (max = 7 se non specificato). Il carico Zipf viene misurato
+ * per ogni esponente s indicato (1 e 1.5 se non specificati): con s = 1 le ricerche
+ * sono poco concentrate, con s = 1.5 la maggior parte cade su poche chiavi.
+ *
+ * Per ogni caso stampa i ns per operazione, le allocazioni fatte durante la costruzione
+ * e il picco di memoria residente. Sui sistemi POSIX ogni caso gira in un processo figlio,
+ * così il picco di memoria è quello del solo caso. I semi dei generatori sono fissi.
+ *
+ * Uso: bench.exe [max] [filtro] [s...], dove filtro seleziona i casi il cui tipo, carico
+ * o contenitore coincide con la stringa indicata (ad esempio `bench.exe 5 avl`, oppure
+ * `bench.exe 6 zipf 1.2 2` per il solo carico Zipf con s = 1.2 e s = 2); `all` li seleziona tutti.
+ */
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <set>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <sstream>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BENCH_HAVE_FORK
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "bst.hpp"
+#include "compact_bst.hpp"
+
+static unsigned long long allocations = 0; //< chiamate a operator new dall'avvio del processo
+
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE
+#endif
+
+/**
+ * @brief Alloca size byte con malloc e conta l'allocazione.
+ *
+ * malloc e free restano in funzioni non espanse in linea: altrimenti il compilatore
+ * vede free applicata al risultato di operator new e lo segnala con -Wall.
+ */
+BENCH_NOINLINE static void *bench_alloc(std::size_t size)
+{
+    ++allocations;
+    if (void *p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+/**
+ * @brief Libera un blocco restituito da bench_alloc.
+ */
+BENCH_NOINLINE static void bench_free(void *p) noexcept
+{
+    std::free(p);
+}
+
+void *operator new(std::size_t size)
+{
+    return bench_alloc(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    bench_free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    bench_free(p);
+}
+
+// versioni allineate, usate dal pool dei nodi di bst
+void *operator new(std::size_t size, std::align_val_t align)
+{
+    std::size_t a = std::max(std::size_t(align), sizeof(void *));
+    // il puntatore restituito da malloc è salvato subito prima del blocco allineato
+    void *raw = bench_alloc(size + a);
+    void *p = reinterpret_cast<void *>((reinterpret_cast<std::uintptr_t>(raw) + a) & ~std::uintptr_t(a - 1));
+    static_cast<void **>(p)[-1] = raw;
+    return p;
+}
+
+void operator delete(void *p, std::align_val_t) noexcept
+{
+    if (p != nullptr)
+        bench_free(static_cast<void **>(p)[-1]);
+}
+
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept
+{
+    if (p != nullptr)
+        bench_free(static_cast<void **>(p)[-1]);
+}
+
+/**
+ * @brief Funtore di ordinamento tra tipi interi
+ */
+struct compare_int
+{
+    bool operator()(int a, int b) const
+    {
+        return a < b;
+    }
+};
+
+/**
+ * @brief Funtore di uguaglianza tra tipi interi
+ */
+struct equal_int
+{
+    bool operator()(int a, int b) const
+    {
+        return a == b;
+    }
+};
+
+/**
+ * @brief Funtore di ordinamento tra tipi char
+ */
+struct compare_char
+{
+    bool operator()(char a, char b) const
+    {
+        return a < b;
+    }
+};
+
+/**
+ * @brief Funtore di uguaglianza tra tipi char
+ */
+struct equal_char
+{
+    bool operator()(char a, char b) const
+    {
+        return a == b;
+    }
+};
+
+/**
+ * @brief Squadra identificata dal nome
+ */
+struct team
+{
+    std::string name;
+    int position;
+
+    team(std::string n, int p) : name(n), position(p) {}
+};
+
+/**
+ * @brief Funtore di ordinamento tra tipi team, per nome
+ */
+struct compare_team
+{
+    bool operator()(const team &a, const team &b) const
+    {
+        return a.name < b.name;
+    }
+};
+
+/**
+ * @brief Funtore di uguaglianza tra tipi team, per nome
+ */
+struct equal_team
+{
+    bool operator()(const team &a, const team &b) const
+    {
+        return a.name == b.name;
+    }
+};
+
+/**
+ * @brief Converte un intero nella chiave del tipo misurato.
+ *
+ * Le chiavi dispari non vengono mai inserite: servono per le ricerche senza successo.
+ * Per char le chiavi si ripetono ogni 128 valori.
+ */
+template <typename K>
+K make_key(int k);
+
+template <>
+int make_key<int>(int k)
+{
+    return k;
+}
+
+template <>
+char make_key<char>(int k)
+{
+    return char(k % 128);
+}
+
+template <>
+team make_key<team>(int k)
+{
+    char name[16];
+    std::snprintf(name, sizeof(name), "team%010d", k);
+    return team(name, k);
+}
+
+/**
+ * @brief Valore prodotto dalla visita, usato per impedire al compilatore di eliminarla.
+ */
+inline long long weight(int v) { return v; }
+inline long long weight(char v) { return v; }
+inline long long weight(const team &t) { return t.position; }
+
+// Adattatori: stessa interfaccia per std::set, bst e compact_bst
+
+template <typename K, typename C>
+void insert(std::set<K, C> &s, const K &k)
+{
+    s.insert(k);
+}
+
+template <typename K, typename C, typename E, typename B, typename A, typename S, typename Al>
+void insert(bst<K, C, E, B, A, S, Al> &b, const K &k)
+{
+    b.add(k);
+}
+
+template <typename K, typename C, typename E, typename B>
+void insert(compact_bst<K, C, E, B> &b, const K &k)
+{
+    b.add(k);
+}
+
+template <typename K, typename C>
+bool contains(const std::set<K, C> &s, const K &k)
+{
+    return s.count(k) != 0;
+}
+
+// non costante: con la policy bst_splay la ricerca porta il nodo verso la radice
+template <typename K, typename C, typename E, typename B, typename A, typename S, typename Al>
+bool contains(bst<K, C, E, B, A, S, Al> &b, const K &k)
+{
+    return b.find(k);
+}
+
+template <typename K, typename C, typename E, typename B>
+bool contains(const compact_bst<K, C, E, B> &b, const K &k)
+{
+    return b.find(k);
+}
+
+template <typename K, typename C>
+std::size_t subtree_size(std::set<K, C> &, const K &)
+{
+    return 0;
+}
+
+template <typename K, typename C, typename E, typename B, typename A, typename S, typename Al>
+std::size_t subtree_size(bst<K, C, E, B, A, S, Al> &b, const K &k)
+{
+    return b.subtree(k).size();
+}
+
+template <typename Tree>
+struct has_subtree : std::true_type
+{
+};
+
+template <typename K, typename C>
+struct has_subtree<std::set<K, C>> : std::false_type
+{
+};
+
+template <typename K, typename C, typename E, typename B>
+struct has_subtree<compact_bst<K, C, E, B>> : std::false_type
+{
+};
+
+template <typename K, typename C, typename E, typename B>
+std::size_t subtree_size(compact_bst<K, C, E, B> &, const K &)
+{
+    return 0;
+}
+
+/**
+ * @brief Carichi di lavoro misurati.
+ */
+enum workload
+{
+    random_keys,
+    sorted_keys,
+    reverse_keys,
+    duplicate_keys,
+    zipf_finds
+};
+
+const char *workload_name(workload w)
+{
+    switch (w)
+    {
+    case random_keys:
+        return "random";
+    case sorted_keys:
+        return "sorted";
+    case reverse_keys:
+        return "reverse";
+    case zipf_finds:
+        return "zipf";
+    default:
+        return "duplicates";
+    }
+}
+
+/**
+ * @brief Genera n chiavi (tutte pari) secondo il carico richiesto.
+ */
+std::vector<int> make_keys(workload w, int n)
+{
+    std::mt19937 gen(12345);
+    std::vector<int> keys(n);
+    for (int i = 0; i < n; ++i)
+        keys[i] = 2 * i;
+    switch (w)
+    {
+    case random_keys:
+    case zipf_finds:
+        std::shuffle(keys.begin(), keys.end(), gen);
+        break;
+    case sorted_keys:
+        break;
+    case reverse_keys:
+        std::reverse(keys.begin(), keys.end());
+        break;
+    case duplicate_keys:
+    {
+        // n / 16 valori distinti, ognuno ripetuto in media 16 volte
+        std::uniform_int_distribution<int> pick(0, std::max(1, n / 16) - 1);
+        for (int &k : keys)
+            k = 2 * pick(gen);
+        break;
+    }
+    }
+    return keys;
+}
+
+/**
+ * @brief Restituisce il nome del carico da stampare, con l'esponente per il carico Zipf.
+ */
+std::string load_name(workload w, double s)
+{
+    if (w != zipf_finds)
+        return workload_name(w);
+    std::ostringstream os;
+    os << workload_name(w) << "(s=" << s << ')';
+    return os.str();
+}
+
+/**
+ * @brief Estrae tante chiavi quante ne contiene ranked, secondo una distribuzione di Zipf.
+ *
+ * La chiave ranked[r] viene estratta con probabilità proporzionale a 1 / (r + 1)^s:
+ * più s è grande, più le ricerche si concentrano sulle prime poche chiavi.
+ */
+std::vector<int> zipf_draw(const std::vector<int> &ranked, double s, std::mt19937 &gen)
+{
+    std::vector<double> cdf(ranked.size());
+    double total = 0;
+    for (std::size_t r = 0; r < ranked.size(); ++r)
+        cdf[r] = total += std::pow(double(r + 1), -s);
+    std::uniform_real_distribution<double> u(0.0, total);
+    std::vector<int> out;
+    out.reserve(ranked.size());
+    for (std::size_t i = 0; i < ranked.size(); ++i)
+    {
+        std::size_t r = std::lower_bound(cdf.begin(), cdf.end(), u(gen)) - cdf.begin();
+        out.push_back(ranked[std::min(r, ranked.size() - 1)]);
+    }
+    return out;
+}
+
+/**
+ * @brief Risultati di un caso.
+ */
+struct result
+{
+    double add, find_hit, find_miss, iterate, copy, subtree; //< ns per operazione
+    unsigned long long allocs;                              //< allocazioni durante la costruzione
+    long peak_kb;                                           //< picco di memoria residente in KB
+};
+
+typedef std::chrono::steady_clock bench_clock;
+
+double ns_per(bench_clock::time_point start, std::size_t ops)
+{
+    std::chrono::duration<double, std::nano> elapsed = bench_clock::now() - start;
+    return ops == 0 ? 0.0 : elapsed.count() / double(ops);
+}
+
+/**
+ * @brief Restituisce il picco di memoria residente del processo in KB (-1 se non disponibile).
+ */
+long peak_rss_kb()
+{
+#ifdef BENCH_HAVE_FORK
+    struct rusage u;
+    if (getrusage(RUSAGE_SELF, &u) != 0)
+        return -1;
+#ifdef __APPLE__
+    return long(u.ru_maxrss / 1024);
+#else
+    return long(u.ru_maxrss);
+#endif
+#else
+    return -1;
+#endif
+}
+
+volatile long long sink; //< destinazione dei risultati, per non far eliminare i cicli misurati
+
+/**
+ * @brief Esegue tutte le misure di un caso.
+ *
+ * @param s L'esponente della distribuzione di Zipf, usato solo dal carico zipf_finds.
+ */
+template <typename Tree, typename K>
+result measure(workload w, double s, int n)
+{
+    std::vector<K> keys, hits, misses;
+    {
+        std::vector<int> raw = make_keys(w, n);
+        keys.reserve(n);
+        for (int k : raw)
+            keys.push_back(make_key<K>(k));
+        std::mt19937 gen(54321);
+        std::shuffle(raw.begin(), raw.end(), gen);
+        if (w == zipf_finds)
+            raw = zipf_draw(raw, s, gen);
+        hits.reserve(n);
+        misses.reserve(n);
+        for (int k : raw)
+        {
+            hits.push_back(make_key<K>(k));
+            misses.push_back(make_key<K>(k + 1));
+        }
+    }
+
+    result r;
+    Tree tree;
+    unsigned long long before = allocations;
+    bench_clock::time_point start = bench_clock::now();
+    for (const K &k : keys)
+        insert(tree, k);
+    r.add = ns_per(start, keys.size());
+    r.allocs = allocations - before;
+
+    long long found = 0;
+    start = bench_clock::now();
+    for (const K &k : hits)
+        found += contains(tree, k);
+    r.find_hit = ns_per(start, hits.size());
+
+    start = bench_clock::now();
+    for (const K &k : misses)
+        found += contains(tree, k);
+    r.find_miss = ns_per(start, misses.size());
+
+    long long total = 0;
+    std::size_t visited = 0;
+    start = bench_clock::now();
+    for (const K &v : tree)
+    {
+        total += weight(v);
+        ++visited;
+    }
+    r.iterate = ns_per(start, visited);
+
+    start = bench_clock::now();
+    {
+        Tree copy(tree);
+        total += copy.size();
+    }
+    r.copy = ns_per(start, visited);
+
+    r.subtree = -1;
+    if (has_subtree<Tree>::value)
+    {
+        // sottoalberi radicati in chiavi casuali: in media piccoli, ma include la discesa
+        const std::size_t calls = std::min<std::size_t>(hits.size(), 1000);
+        start = bench_clock::now();
+        for (std::size_t i = 0; i < calls; ++i)
+            total += subtree_size(tree, hits[i]);
+        r.subtree = ns_per(start, calls);
+    }
+
+    sink = found + total;
+    r.peak_kb = peak_rss_kb();
+    return r;
+}
+
+/**
+ * @brief Stampa una riga della tabella dei risultati.
+ */
+void print_row(const char *type, workload w, double s, int n, const char *container, const result &r)
+{
+    std::cout << type << '\t' << load_name(w, s) << '\t' << n << '\t' << container << std::fixed
+              << std::setprecision(1) << '\t' << r.add << '\t' << r.find_hit << '\t' << r.find_miss
+              << '\t' << r.iterate << '\t' << r.copy << '\t';
+    if (r.subtree < 0)
+        std::cout << '-';
+    else
+        std::cout << r.subtree;
+    std::cout << '\t' << r.allocs << '\t' << r.peak_kb << '\n';
+    std::cout.flush();
+}
+
+/**
+ * @brief Misura un caso, in un processo figlio se possibile, e ne stampa la riga.
+ */
+template <typename Tree, typename K>
+void run_case(const char *type, workload w, double s, int n, const char *container)
+{
+#ifdef BENCH_HAVE_FORK
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        print_row(type, w, s, n, container, measure<Tree, K>(w, s, n));
+        std::_Exit(0);
+    }
+    if (pid > 0)
+    {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            std::cout << type << '\t' << load_name(w, s) << '\t' << n << '\t' << container << "\tFAILED" << std::endl;
+        return;
+    }
+#endif
+    print_row(type, w, s, n, container, measure<Tree, K>(w, s, n));
+}
+
+/**
+ * @brief Indica se il caso va eseguito con il filtro della riga di comando.
+ */
+bool selected(const char *filter, const char *type, workload w, const char *container)
+{
+    if (filter == nullptr || std::string(filter) == "all")
+        return true;
+    std::string f(filter);
+    return f == type || f == workload_name(w) || f == container;
+}
+
+/**
+ * @brief Misura tutti i contenitori per un tipo di chiave e un carico, per ogni dimensione.
+ *
+ * Gli alberi usano l'uguaglianza di default ricavata da `Comp` (un confronto per livello);
+ * solo la colonna avl_equal usa `Equal` esplicito, per misurare la discesa con due confronti.
+ */
+template <typename K, typename Comp, typename Equal>
+void run_sizes(const char *type, workload w, double s, int max_exp, const char *filter)
+{
+    int n = 1000;
+    for (int e = 3; e <= max_exp; ++e, n *= 10)
+    {
+        if (selected(filter, type, w, "std::set"))
+            run_case<std::set<K, Comp>, K>(type, w, s, n, "std::set");
+        // chiavi ordinate: l'albero non bilanciato degenera in una lista e costa O(n^2)
+        bool degenerate = (w == sorted_keys || w == reverse_keys) && n > 10000;
+        if (selected(filter, type, w, "bst") && !degenerate)
+            run_case<bst<K, Comp>, K>(type, w, s, n, "bst");
+        if (selected(filter, type, w, "avl"))
+            run_case<bst<K, Comp, bst_equivalent<Comp>, bst_avl>, K>(type, w, s, n, "avl");
+        if (selected(filter, type, w, "avl_equal"))
+            run_case<bst<K, Comp, Equal, bst_avl>, K>(type, w, s, n, "avl_equal");
+        if (selected(filter, type, w, "threaded"))
+            run_case<bst<K, Comp, bst_equivalent<Comp>, bst_avl, bst_threaded>, K>(type, w, s, n, "threaded");
+        if (selected(filter, type, w, "compact"))
+            run_case<compact_bst<K, Comp, bst_equivalent<Comp>, bst_avl>, K>(type, w, s, n, "compact");
+        if (selected(filter, type, w, "splay"))
+            run_case<bst<K, Comp, bst_equivalent<Comp>, bst_splay<>>, K>(type, w, s, n, "splay");
+        if (selected(filter, type, w, "splay16"))
+            run_case<bst<K, Comp, bst_equivalent<Comp>, bst_splay<16>>, K>(type, w, s, n, "splay16");
+    }
+}
+
+/**
+ * @brief Misura tutti i contenitori per un tipo di chiave.
+ */
+template <typename K, typename Comp, typename Equal>
+void run_type(const char *type, int max_exp, const char *filter, const std::vector<double> &exponents)
+{
+    const workload workloads[] = {random_keys, sorted_keys, reverse_keys, duplicate_keys, zipf_finds};
+    for (workload w : workloads)
+    {
+        // solo il carico Zipf dipende dall'esponente
+        std::vector<double> loads = w == zipf_finds ? exponents : std::vector<double>(1, 0.0);
+        for (double s : loads)
+            run_sizes<K, Comp, Equal>(type, w, s, max_exp, filter);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int max_exp = 7;
+    if (argc > 1)
+        max_exp = std::atoi(argv[1]);
+    // n è un int e il ciclo su n *= 10 arriva fino a 10^(max_exp + 1)
+    if (max_exp < 3)
+        max_exp = 3;
+    if (max_exp > 8)
+        max_exp = 8;
+    const char *filter = argc > 2 ? argv[2] : nullptr;
+    std::vector<double> exponents;
+    for (int i = 3; i < argc; ++i)
+        exponents.push_back(std::atof(argv[i]));
+    if (exponents.empty())
+        exponents = {1.0, 1.5};
+
+    std::cout << "type\tworkload\tn\tcontainer\tadd\tfind_hit\tfind_miss\titerate\tcopy\tsubtree"
+                 "\tallocs\tpeak_rss_kb"
+              << std::endl;
+    std::cout << "# ns/op; iterate e copy per elemento; allocs durante gli add; bst non bilanciato"
+                 " saltato per chiavi ordinate oltre 10^4; zipf: chiavi casuali, ricerche secondo Zipf con esponente s;"
+                 " splay16 = bst_splay<16>; avl_equal = avl con Equal esplicito"
+              << std::endl;
+    run_type<int, compare_int, equal_int>("int", max_exp, filter, exponents);
+    run_type<char, compare_char, equal_char>("char", max_exp, filter, exponents);
+    run_type<team, compare_team, equal_team>("team", max_exp, filter, exponents);
+    return 0;
+}
@@ -1,680 +1,4474 @@
-#ifndef BST_HPP
-#define BST_HPP
-
-#include <iterator>
-#include <cstddef>
-#include <iostream>
-#include <cassert>
-#include <algorithm>
-
-/**
- * @brief Implementazione di un albero binario di ricerca.
- *
- * La classe `bst` implementa un albero binario di ricerca, in cui ogni nodo contiene un valore di tipo `T`.
- * L'ordine dei nodi è determinato dalla funzione di confronto `Comp` e dalla funzione di uguaglianza `Equal`.
- * L'albero supporta operazioni come l'aggiunta di un nodo, la ricerca di un valore e la stampa degli elementi.
- *
- * @tparam T Il tipo di valore contenuto nei nodi dell'albero.
- * @tparam Comp Il tipo di funzione di confronto per ordinare i nodi.
- * @tparam Equal Il tipo di funzione di uguaglianza per confrontare i valori dei nodi.
- */
-template <typename T, typename Comp, typename Equal>
-class bst
-{
-    /**
-     * @brief Struttura che rappresenta un nodo di un albero binario di ricerca.
-     *
-     * @tparam T Il tipo di dato contenuto nel nodo.
-     */
-    struct node
-    {
-        T value;      //< valore del nodo
-        node *left;   //< puntatore al nodo figlio sinistro
-        node *right;  //< puntatore al nodo figlio destro
-        node *parent; //< puntatore al nodo genitore
-
-        /**
-         * @brief Costruttore di default della struttura node.
-         *
-         * @post left == nullptr
-         * @post right == nullptr
-         * @post parent == nullptr
-         */
-        node() : left(nullptr), right(nullptr), parent(nullptr)
-        {
-#ifndef NDEBUG
-            std::cout << "node::node()" << std::endl;
-#endif
-        };
-
-        /**
-         * @brief Costruttore della struttura node.
-         *
-         * @param v Il valore del nodo.
-         * @param l Il puntatore al nodo figlio sinistro.
-         * @param r Il puntatore al nodo figlio destro.
-         * @param p Il puntatore al nodo genitore.
-         *
-         * @post value == v
-         * @post left == l
-         * @post right == r
-         * @post parent == p
-         */
-        node(const T &v, node *l, node *r, node *p) : value(v), left(l), right(r), parent(p) {};
-
-        /**
-         * @brief Costruttore della struttura node.
-         *
-         * @param v Il valore del nodo.
-         *
-         * @post value == v
-         * @post left == nullptr
-         * @post right == nullptr
-         * @post parent == nullptr
-         */
-        node(const T &v) : value(v), left(nullptr), right(nullptr), parent(nullptr) {};
-    };
-
-    node *_root;        //< puntatore alla radice dell'albero
-    unsigned int _size; //< numero di nodi dell'albero
-    Comp _compare;      //< funtore per il confronto tra i valori dei nodi
-    Equal _equal;       //< funtore per l'uguaglianza tra i valori dei nodi
-
-public:
-    /**
-     * @brief Classe che rappresenta un albero binario di ricerca.
-     *
-     * Questa classe implementa un albero binario di ricerca, in cui ogni nodo
-     * contiene un valore e due puntatori ai suoi figli sinistro e destro.
-     *
-     * @post _root == nullptr
-     * @post _size == 0
-     */
-    bst() : _root(nullptr), _size(0)
-    {
-#ifndef NDEBUG
-        std::cout << "bst::bst()" << std::endl;
-#endif
-    };
-
-    /**
-     * @brief Costruttore della classe bst.
-     *
-     * Questo costruttore crea un nuovo albero binario di ricerca (bst)
-     * con un nodo radice iniziale.
-     *
-     * @param value Il valore del nodo radice.
-     *
-     * @throw Eccezione standard in caso di errore nella creazione del nodo radice.
-     */
-    bst(const T &value) : _size(1)
-    {
-        try
-        {
-            _root = new node(value);
-#ifndef NDEBUG
-            std::cout << "bst::bst(node value " << value << " )" << std::endl;
-#endif
-        }
-        catch (...)
-        {
-            destroy_tree(_root);
-            throw;
-        }
-    };
-
-    /**
-     * @brief Copia ricorsivamente i nodi di un'altra istanza di bst nel bst corrente.
-     *
-     * @param c L'istanza di bst da cui copiare i nodi.
-     * @param root Il nodo radice dell'albero da copiare.
-     *
-     * @throw Eccezione generica se si verifica un errore durante la copia.
-     */
-    void copyRic(bst &c, const node *root)
-    {
-        try
-        {
-            if (root != nullptr)
-            {
-                c.add(root->value);
-                copyRic(c, root->left);
-                copyRic(c, root->right);
-            }
-        }
-        catch (...)
-        {
-            destroy_tree(_root);
-            throw;
-        }
-    }
-
-    /**
-     * @brief Copy constructor
-     *
-     * Costruttore di copia della classe bst.
-     *
-     * @param other L'albero binario di ricerca da copiare.
-     */
-    bst(const bst &other) : _root(nullptr), _size(0)
-    {
-        try
-        {
-            copyRic(*this, other._root);
-        }
-        catch (...)
-        {
-            destroy_tree(_root);
-            throw;
-        }
-#ifndef NDEBUG
-        std::cout << "bst::bst(const bst &other)" << std::endl;
-#endif
-    }
-
-    /**
-     * @brief Operatore assegnazione
-     *
-     * Questo operatore assegna un'altra istanza di bst all'istanza corrente.
-     *
-     * @param other L'albero binario di ricerca da copiare.
-     * @return reference all'istanza di bst corrente.
-     */
-    bst &operator=(const bst &other)
-    {
-        if (this != &other)
-        {
-            bst tmp(other);
-            swap(tmp);
-#ifndef NDEBUG
-            std::cout << "bst::operator=(const bst &other)" << std::endl;
-#endif
-        }
-
-        return *this;
-    }
-
-    /**
-     * @brief Distruttore della classe bst.
-     *
-     * Questo distruttore si occupa di deallocare tutti i nodi dell'albero binario di ricerca.
-     *
-     * @post _root == nullptr
-     */
-    ~bst()
-    {
-        destroy_tree(_root);
-        _size = 0;
-
-#ifndef NDEBUG
-        std::cout << "bst::~bst()" << std::endl;
-#endif
-    }
-
-    /**
-     * @brief Costruisce un albero binario di ricerca a partire da una sequenza di elementi.
-     *
-     * Questo costruttore crea un albero binario di ricerca a partire da una sequenza di elementi
-     * definita dall'iteratore di inizio e l'iteratore di fine.
-     *
-     * @tparam Iter Il tipo dell'iteratore.
-     * @param begin L'iteratore di inizio della sequenza.
-     * @param end L'iteratore di fine della sequenza.
-     *
-     * @throw Eccezione generata durante l'inserimento degli elementi.
-     */
-    template <typename Iter>
-    bst(Iter begin, Iter end) : _root(nullptr), _size(0)
-    {
-        try
-        {
-            Iter it = begin;
-            for (; it != end; ++it)
-            {
-                add(*it);
-            }
-        }
-        catch (...)
-        {
-            destroy_tree(_root);
-            throw;
-        }
-#ifndef NDEBUG
-        std::cout << "bst::bst(Iter begin, Iter end)" << std::endl;
-#endif
-    }
-
-    /**
-     * @brief Aggiunge un valore all'albero binario di ricerca.
-     *
-     * Questo metodo aggiunge un nuovo nodo contenente il valore specificato all'albero binario di ricerca.
-     * Se il valore è già presente nell'albero, il nodo non viene aggiunto.
-     *
-     * @param value Il valore da aggiungere all'albero.
-     *
-     * @throw Eccezione generica se si verifica un errore durante l'aggiunta del nodo.
-     */
-    void add(const T &value)
-    {
-        try
-        {
-            node *temp = new node(value);
-            if (_root == nullptr)
-            {
-                _root = temp;
-                _size++;
-#ifndef NDEBUG
-                std::cout << "bst::add() root = " << value << std::endl;
-#endif
-            }
-            else
-            {
-                node *curr = _root;
-                node *parent;
-                while (curr != nullptr)
-                {
-                    parent = curr;
-                    if (_equal(value, curr->value))
-                    {
-#ifndef NDEBUG
-                        std::cout << "bst::add() equal, delete value" << std::endl;
-#endif
-                        delete temp;
-                        return;
-                    }
-                    if (_compare(value, curr->value))
-                    {
-                        curr = curr->left;
-#ifndef NDEBUG
-                        std::cout << "bst::add() go to the left" << std::endl;
-#endif
-                    }
-                    else
-                    {
-                        curr = curr->right;
-#ifndef NDEBUG
-                        std::cout << "bst::add() go to the  right" << std::endl;
-#endif
-                    }
-                }
-                if (_compare(value, parent->value))
-                {
-                    temp->parent = parent;
-                    parent->left = temp;
-                }
-                else
-                {
-                    temp->parent = parent;
-                    parent->right = temp;
-                }
-
-                _size++;
-#ifndef NDEBUG
-                std::cout << "bst::add() add leaf = " << value << std::endl;
-#endif
-            }
-        }
-        catch (...)
-        {
-            destroy_tree(_root);
-            throw;
-        }
-    }
-
-    /**
-     * @brief Scambia il contenuto di due alberi binari di ricerca.
-     *
-     * Questa funzione scambia il contenuto dell'albero binario di ricerca
-     * corrente con un altro albero binario di ricerca specificato.
-     *
-     * @param other L'albero binario di ricerca con cui scambiare il contenuto.
-     */
-    void swap(bst &other)
-    {
-        std::swap(_root, other._root);
-        std::swap(_size, other._size);
-    }
-
-    /**
-     * @brief Restituisce la dimensione dell'albero.
-     *
-     * @return La dimensione dell'albero.
-     */
-    unsigned int size() const
-    {
-        return _size;
-    }
-
-    /**
-     * @brief Trova un valore nell'albero binario di ricerca.
-     *
-     * Questo metodo cerca un valore specifico nell'albero binario di ricerca.
-     * Restituisce true se il valore viene trovato, altrimenti restituisce false.
-     *
-     * @param value Il valore da cercare nell'albero.
-     * @return True se il valore viene trovato, altrimenti false.
-     */
-    bool find(const T &value) const
-    {
-        node *curr = _root;
-        while (curr != nullptr)
-        {
-            if (_equal(value, curr->value))
-                return true;
-            if (_compare(value, curr->value))
-                curr = curr->left;
-            else
-                curr = curr->right;
-        }
-        return false;
-    }
-
-    /**
-     * @brief Restituisce un sottoalbero con radice nel nodo contenente il valore specificato.
-     *
-     * Se il valore specificato non viene trovato nel BST, viene restituito un BST vuoto.
-     *
-     * @param value Il valore da cercare nel BST.
-     * @return Un BST che rappresenta il sottoalbero con radice nel nodo contenente il valore specificato.
-     * @throw Nessuna eccezione viene generata da questa funzione.
-     */
-    bst subtree(const T &value)
-    {
-        if (!find(value))
-        {
-#ifndef NDEBUG
-            std::cout << "bst::subtree() value " << value << " not found" << std::endl;
-#endif
-            return bst();
-        }
-        else
-        {
-            bst b;
-            node *curr = _root;
-            while (!_equal(value, curr->value))
-            {
-                if (_compare(value, curr->value))
-                    curr = curr->left;
-                else
-                    curr = curr->right;
-            }
-#ifndef NDEBUG
-            std::cout << "bst::subtree() value " << value << " found" << std::endl;
-#endif
-            copyRic(b, curr);
-            return b;
-        }
-    }
-
-    /**
-     * @brief Distrugge l'albero a partire dal nodo specificato.
-     *
-     * Questa funzione ricorsiva distrugge l'albero a partire dal nodo specificato.
-     * Viene chiamata ricorsivamente per distruggere i sottoalberi sinistro e destro,
-     * quindi imposta il puntatore del nodo a nullptr e dealloca la memoria.
-     *
-     * @param leaf Il nodo radice dell'albero da distruggere.
-     *
-     * @post _root == nullptr
-     */
-    void destroy_tree(node *leaf)
-    {
-        if (leaf != nullptr)
-        {
-            destroy_tree(leaf->left);
-            destroy_tree(leaf->right);
-            delete leaf;
-        }
-    }
-
-    /**
-     * @brief Stampa i valori dei nodi dell'albero in ordine.
-     *
-     * Questa funzione stampa i valori dei nodi dell'albero in ordine, visitando prima il sottoalbero sinistro,
-     * poi il nodo corrente e infine il sottoalbero destro.
-     *
-     * @param root Il puntatore alla radice dell'albero.
-     * @param os Lo stream di output su cui stampare i valori dei nodi.
-     */
-    static void print(node *root, std::ostream &os)
-    {
-        if (root != nullptr)
-        {
-            print(root->left, os);
-            os << root->value << ' ';
-            print(root->right, os);
-        }
-    }
-
-    /**
-     * Funzione GOBLALE che implementa l'operatore di stream.
-     * La funzione è templata sull'albero binario di ricerca ed è messa
-     * friend per accedere ai dati privati dell'albero.
-     *
-     * @param os Lo stream di output su cui stampare i valori dei nodi.
-     * @param b L'albero binario di ricerca da stampare.
-     * @return Lo stream di output su cui sono stati stampati i valori dei nodi.
-     */
-    friend std::ostream &operator<<(std::ostream &os, const bst &b)
-    {
-        node *curr = b._root;
-
-        print(curr, os);
-
-        return os;
-    }
-
-    /**
-     * Classe che rappresenta un iteratore costante per la classe bst.
-     * Fornisce un'interfaccia per iterare in modo costante sugli elementi di un oggetto bst.
-     */
-    class const_iterator
-    {
-    public:
-        typedef std::forward_iterator_tag iterator_category;
-        typedef T value_type;
-        typedef ptrdiff_t difference_type;
-        typedef const T *pointer;
-        typedef const T &reference;
-
-        /**
-         * @brief Costruttore di default.
-         */
-        const_iterator() : n(nullptr) {}
-
-        /**
-         * @brief Costruttore di copia.
-         *
-         * @param other L'iteratore da copiare.
-         */
-        const_iterator(const const_iterator &other) : n(other.n) {}
-
-        /**
-         * @brief Operatore di assegnazione.
-         *
-         * @param other L'iteratore da assegnare.
-         * @return Un riferimento a se stesso.
-         */
-        const_iterator &operator=(const const_iterator &other)
-        {
-            n = other.n;
-            return *this;
-        }
-
-        /**
-         * @brief Distruttore.
-         */
-        ~const_iterator() {}
-
-        /**
-         * @brief Operatore di dereferenziazione.
-         *
-         * @return Il riferimento costante all'elemento puntato dall'iteratore.
-         */
-        reference operator*() const
-        {
-            return n->value;
-        }
-
-        /**
-         * @brief Operatore di accesso ai membri.
-         *
-         * @return Il puntatore costante all'elemento puntato dall'iteratore.
-         */
-        pointer operator->() const
-        {
-            return &(n->value);
-        }
-
-        /**
-         * @brief Operatore di post-incremento.
-         *
-         * @return Un iteratore costante che punta all'elemento precedente.
-         */
-        const_iterator operator++(int)
-        {
-            const_iterator tmp(*this);
-            if (n->right == nullptr)
-            {
-#ifndef NDEBUG
-                std::cout << "n->right == nullptr" << std::endl;
-#endif
-                while (n->parent != nullptr && n->parent->right == n)
-                {
-                    n = n->parent;
-#ifndef NDEBUG
-                    std::cout << "n->parent->right == n" << std::endl;
-#endif
-                }
-                n = n->parent;
-                return tmp;
-            }
-            else
-            {
-#ifndef NDEBUG
-                std::cout << "n->right != nullptr" << std::endl;
-#endif
-                n = n->right;
-                while (n->left != nullptr)
-                {
-                    n = n->left;
-                }
-                return tmp;
-            }
-        }
-
-        /**
-         * @brief Operatore di pre-incremento.
-         *
-         * @return Un riferimento a se stesso.
-         */
-        const_iterator &operator++()
-        {
-            if (n->right == nullptr)
-            {
-                while (n->parent != nullptr && n->parent->right == n)
-                {
-                    n = n->parent;
-                }
-                n = n->parent;
-                return *this;
-            }
-            else
-            {
-                n = n->right;
-                while (n->left != nullptr)
-                {
-                    n = n->left;
-                }
-                return *this;
-            }
-        }
-
-        /**
-         * @brief Operatore di uguaglianza.
-         *
-         * @param other L'iteratore da confrontare.
-         * @return True se gli iteratori sono uguali, false altrimenti.
-         */
-        bool operator==(const const_iterator &other) const
-        {
-            return n == other.n;
-        }
-
-        /**
-         * @brief Operatore di disuguaglianza.
-         *
-         * @param other L'iteratore da confrontare.
-         * @return True se gli iteratori sono diversi, false altrimenti.
-         */
-        bool operator!=(const const_iterator &other) const
-        {
-            return !(other == *this);
-        }
-
-    private:
-        const node *n;
-
-        friend class bst;
-
-        /**
-         * @brief Costruttore privato.
-         *
-         * @param n Il puntatore al nodo dell'iteratore.
-         */
-        const_iterator(const node *n) : n(n) {}
-    };
-
-    /**
-     * @brief Restituisce un iteratore costante che punta all'inizio dell'albero binario di ricerca.
-     *
-     * @return Un iteratore costante che punta all'elemento minimo dell'albero binario di ricerca.
-     */
-    const_iterator begin() const
-    {
-        node *min = _root;
-        while (min->left != nullptr)
-        {
-            min = min->left;
-        }
-        return const_iterator(min);
-    }
-
-    /**
-     * @brief Restituisce un iteratore costante che punta alla fine della struttura dati.
-     *
-     * @return Un iteratore costante che punta alla fine della struttura dati.
-     */
-    const_iterator end() const
-    {
-        return const_iterator(nullptr);
-    }
-};
-
-/**
- * Funzione GLOBALE che stampa a schermo i soli valori
- * dei nodi di un albero binario di ricerca
- * che soddisfano un predicato specificato dall'utente.
- *
- * @tparam T Il tipo degli elementi nell'albero binario di ricerca.
- * @tparam Comp Il funtore di confronto per ordinare gli elementi nell'albero.
- * @tparam Equal Il funtore di confronto per verificare l'uguaglianza tra gli elementi.
- * @tparam P Il tipo del predicato da utilizzare per filtrare gli elementi.
- *
- * @param b L'albero binario di ricerca da stampare.
- * @param pred Il predicato da utilizzare per filtrare gli elementi.
- */
-template <typename T, typename Comp, typename Equal, typename P>
-void printIF(const bst<T, Comp, Equal> &b, P pred)
-{
-    typename bst<T, Comp, Equal>::const_iterator i, ie;
-    for (i = b.begin(), ie = b.end(); i != ie; ++i)
-    {
-        if (pred(*i))
-        {
-            std::cout << *i << std::endl;
-        }
-    }
-}
-
+#ifndef BST_HPP
+#define BST_HPP
+
+#include <iterator>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <type_traits>
+#include <new>
+#include <utility>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <ostream>
+#include <streambuf>
+#include <functional>
+#include <memory_resource>
+#if __cplusplus >= 202002L
+#include <ranges>
+#include <compare>
+#include <concepts>
+#endif
+
+#include "frozen_bst.hpp"
+
+/**
+ * @brief Policy di bilanciamento nulla.
+ *
+ * L'albero viene costruito esattamente nell'ordine di inserimento, senza alcuna rotazione.
+ * Inserendo chiavi ordinate l'albero degenera in una lista.
+ */
+struct bst_unbalanced
+{
+    /**
+     * @brief Informazioni aggiuntive memorizzate in ogni nodo (nessuna).
+     */
+    struct node_meta
+    {
+    };
+};
+
+/**
+ * @brief Policy di bilanciamento AVL.
+ *
+ * Dopo ogni inserimento l'albero viene ribilanciato tramite rotazioni in modo che,
+ * per ogni nodo, le altezze dei due sottoalberi differiscano al più di uno.
+ * L'altezza dell'albero resta quindi O(log n) qualunque sia l'ordine di inserimento.
+ */
+struct bst_avl
+{
+    /**
+     * @brief Informazioni aggiuntive memorizzate in ogni nodo.
+     */
+    struct node_meta
+    {
+        unsigned char height; //< altezza del sottoalbero radicato nel nodo
+
+        node_meta() : height(1) {}
+    };
+};
+
+/**
+ * @brief Policy autoaggiustante (splay).
+ *
+ * Gli accessi (`find` su un albero non costante e inserimenti) portano alla radice, con le
+ * rotazioni zig-zig e zig-zag, i nodi richiesti spesso. Ogni nodo conta i propri accessi e viene
+ * spostato quando il conteggio raggiunge Threshold, che poi riparte da zero: con Threshold = 1
+ * è lo splay classico, con valori maggiori le chiavi richieste di rado non scalzano dalla cima
+ * quelle più richieste. L'inserimento conta come primo accesso al nuovo nodo, quindi lo porta
+ * alla radice solo con Threshold = 1. Con accessi molto sbilanciati (ad esempio una
+ * distribuzione di Zipf) le chiavi più frequenti restano vicino alla radice. Un `find` su
+ * un albero costante non modifica la forma.
+ *
+ * Il costo è O(log n) ammortizzato con Threshold = 1, ma la singola operazione può essere lineare
+ * e nessuna profondità è garantita. Poiché `find` modifica l'albero, più thread non possono
+ * cercare insieme nello stesso albero senza sincronizzazione, a differenza delle altre policy.
+ *
+ * @tparam Threshold Il numero di accessi a un nodo che lo portano alla radice (almeno 1).
+ */
+template <unsigned int Threshold = 1>
+struct bst_splay
+{
+    static_assert(Threshold > 0, "bst_splay: Threshold deve essere almeno 1");
+
+    /**
+     * @brief Informazioni aggiuntive memorizzate in ogni nodo.
+     */
+    struct node_meta
+    {
+        unsigned int hits; //< accessi al nodo dall'ultima volta che è stato portato alla radice
+
+        node_meta() : hits(0) {}
+    };
+
+    static constexpr unsigned int threshold = Threshold; //< accessi che portano un nodo alla radice
+};
+
+/**
+ * @brief Nessuna informazione aggiuntiva nei nodi.
+ */
+struct bst_no_augment
+{
+    /**
+     * @brief Informazioni aggiuntive memorizzate in ogni nodo (nessuna).
+     */
+    struct node_meta
+    {
+    };
+};
+
+/**
+ * @brief Aumento per statistiche d'ordine.
+ *
+ * Ogni nodo memorizza il numero di nodi del proprio sottoalbero, mantenuto da
+ * inserimenti, rimozioni e rotazioni. Abilita `rank`, `select` e `count_range` in O(h).
+ */
+struct bst_order_statistics
+{
+    /**
+     * @brief Informazioni aggiuntive memorizzate in ogni nodo.
+     */
+    struct node_meta
+    {
+        unsigned int count; //< numero di nodi del sottoalbero radicato nel nodo
+
+        node_meta() : count(1) {}
+    };
+};
+
+/**
+ * @brief Aumento per la visita in ordine tramite collegamenti (albero "threaded").
+ *
+ * Ogni nodo memorizza il proprio predecessore e successore in ordine, mantenuti da
+ * inserimenti, rimozioni e costruzioni in blocco: `++` e `--` degli iteratori sull'intero
+ * albero seguono un solo puntatore, senza risalire i genitori.
+ */
+struct bst_threaded
+{
+    /**
+     * @brief Informazioni aggiuntive memorizzate in ogni nodo.
+     *
+     * I puntatori sono generici perché il tipo del nodo dipende dall'albero.
+     */
+    struct node_meta
+    {
+        void *prev; //< predecessore in ordine (nullptr per il minimo)
+        void *next; //< successore in ordine (nullptr per il massimo)
+
+        node_meta() : prev(nullptr), next(nullptr) {}
+    };
+};
+
+/**
+ * @brief Aumento che unisce `bst_order_statistics` e `bst_threaded`.
+ */
+struct bst_threaded_order_statistics
+{
+    /**
+     * @brief Informazioni aggiuntive memorizzate in ogni nodo.
+     */
+    struct node_meta : bst_order_statistics::node_meta, bst_threaded::node_meta
+    {
+    };
+};
+
+/**
+ * @brief Policy di strumentazione nulla.
+ *
+ * Tutti i punti di misura sono funzioni vuote che il compilatore elimina:
+ * l'albero non paga nulla, né in tempo né in I/O.
+ */
+struct bst_no_stats
+{
+    void compare() const {}
+    void allocate(std::size_t) const {}
+    void deallocate(std::size_t) const {}
+    void descent(unsigned int) const {}
+};
+
+/**
+ * @brief Policy di strumentazione che conta le operazioni dell'albero.
+ *
+ * I contatori appartengono al singolo oggetto `bst` (non vengono copiati né scambiati)
+ * e si leggono con `bst::stats()`. Non sono atomici: le letture concorrenti
+ * dello stesso albero (ad esempio `parallel_for_each_if`) non vanno misurate.
+ */
+struct bst_counting_stats
+{
+    unsigned long long comparisons;   //< chiamate ai funtori Comp ed Equal
+    unsigned long long allocations;   //< nodi allocati
+    unsigned long long deallocations; //< nodi liberati
+    unsigned long long operations;    //< discese dalla radice (ricerche, inserimenti, rimozioni, ...)
+    unsigned long long total_path;    //< somma dei nodi visitati dalle discese
+    unsigned int last_path;           //< nodi visitati dall'ultima discesa
+    unsigned int max_depth;           //< nodi visitati dalla discesa più lunga
+
+    bst_counting_stats()
+        : comparisons(0), allocations(0), deallocations(0), operations(0), total_path(0),
+          last_path(0), max_depth(0) {}
+
+    void compare()
+    {
+        ++comparisons;
+    }
+
+    void allocate(std::size_t n)
+    {
+        allocations += n;
+    }
+
+    void deallocate(std::size_t n)
+    {
+        deallocations += n;
+    }
+
+    void descent(unsigned int path)
+    {
+        ++operations;
+        total_path += path;
+        last_path = path;
+        if (path > max_depth)
+            max_depth = path;
+    }
+
+    /**
+     * @brief Restituisce la lunghezza media delle discese.
+     *
+     * @return Il numero medio di nodi visitati per discesa (0 se non ce ne sono state).
+     */
+    double mean_path() const
+    {
+        return operations == 0 ? 0.0 : double(total_path) / double(operations);
+    }
+
+    /**
+     * Funzione GLOBALE che implementa l'operatore di stream.
+     *
+     * @param os Lo stream di output su cui stampare i contatori.
+     * @param s I contatori da stampare.
+     * @return Lo stream di output.
+     */
+    friend std::ostream &operator<<(std::ostream &os, const bst_counting_stats &s)
+    {
+        return os << "comparisons=" << s.comparisons << " allocations=" << s.allocations
+                  << " deallocations=" << s.deallocations << " operations=" << s.operations
+                  << " mean_path=" << s.mean_path() << " max_depth=" << s.max_depth;
+    }
+};
+
+/**
+ * @brief Uguaglianza ricavata dalla funzione di confronto: a e b sono uguali se nessuno precede l'altro.
+ *
+ * È il valore di default di `Equal` in `bst`. Con questa uguaglianza l'albero scende
+ * con un solo confronto per livello invece di due (vedi `bst_derived_equal`).
+ *
+ * @tparam Comp Il tipo di funzione di confronto.
+ */
+template <typename Comp>
+struct bst_equivalent
+{
+    Comp compare; //< funtore di confronto
+
+    template <typename A, typename B>
+    bool operator()(const A &a, const B &b) const
+    {
+        return !compare(a, b) && !compare(b, a);
+    }
+};
+
+/**
+ * @brief Vale true se `Equal` coincide con l'equivalenza indotta da `Comp`.
+ *
+ * Vero solo per `bst_equivalent<Comp>`. Per altre coppie di funtori si può specializzare,
+ * purché `Equal(a, b)` sia sempre uguale a `!Comp(a, b) && !Comp(b, a)`: non vale in
+ * generale nemmeno per `std::less` / `std::equal_to` (ad esempio con i NaN dei double).
+ */
+template <typename Comp, typename Equal>
+struct bst_derived_equal : std::false_type
+{
+};
+
+template <typename Comp>
+struct bst_derived_equal<Comp, bst_equivalent<Comp>> : std::true_type
+{
+};
+
+/**
+ * @brief Tag per costruire un `bst` o un `compact_bst` da una sequenza strettamente crescente.
+ *
+ * La sequenza non deve contenere duplicati (controllato con `assert`); per una sequenza
+ * ordinata con duplicati si usa il costruttore da iteratori.
+ *
+ * Esempio: `bst<int, compare_int, equal_int> b(bst_from_sorted, v.begin(), v.end());`
+ */
+struct bst_from_sorted_t
+{
+    explicit bst_from_sorted_t() = default;
+};
+
+inline constexpr bst_from_sorted_t bst_from_sorted{};
+
+/**
+ * @brief Tag per costruire un `bst` in parallelo da una sequenza qualsiasi.
+ *
+ * Esempio: `bst<int, compare_int, equal_int> b(bst_parallel, v.begin(), v.end(), 8);`
+ */
+struct bst_parallel_t
+{
+    explicit bst_parallel_t() = default;
+};
+
+inline constexpr bst_parallel_t bst_parallel{};
+
+/**
+ * @brief Buffer di scrittura verso lo streambuf di un altro stream.
+ *
+ * Accumula i caratteri in un blocco di memoria e li passa allo stream di destinazione
+ * solo quando il blocco è pieno o alla chiusura, con una sola `sputn` per blocco.
+ * Non svuota mai lo stream di destinazione: decide il chiamante se e quando farlo.
+ */
+class bst_output_buffer : public std::streambuf
+{
+public:
+    static const std::size_t block = 1 << 16; //< dimensione del blocco in byte
+
+    /**
+     * @brief Costruttore.
+     *
+     * @param sink Lo stream su cui riversare i caratteri.
+     */
+    explicit bst_output_buffer(std::ostream &sink) : _sink(sink), _data(block)
+    {
+        setp(_data.data(), _data.data() + _data.size());
+    }
+
+    bst_output_buffer(const bst_output_buffer &) = delete;
+    bst_output_buffer &operator=(const bst_output_buffer &) = delete;
+
+    /**
+     * @brief Distruttore: riversa i caratteri rimasti nel buffer.
+     */
+    ~bst_output_buffer()
+    {
+        drain();
+    }
+
+protected:
+    int_type overflow(int_type c) override
+    {
+        if (!drain())
+            return traits_type::eof();
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override
+    {
+        return drain() ? 0 : -1;
+    }
+
+private:
+    std::ostream &_sink;     //< stream di destinazione
+    std::vector<char> _data; //< blocco di appoggio
+
+    /**
+     * @brief Passa allo stream di destinazione i caratteri accumulati.
+     *
+     * @return False se lo stream di destinazione non li ha accettati tutti.
+     */
+    bool drain()
+    {
+        std::streamsize n = pptr() - pbase();
+        setp(_data.data(), _data.data() + _data.size());
+        if (n == 0)
+            return true;
+        if (!_sink.good() || _sink.rdbuf() == nullptr || _sink.rdbuf()->sputn(_data.data(), n) != n)
+        {
+            _sink.setstate(std::ios_base::badbit);
+            return false;
+        }
+        return true;
+    }
+};
+
+/**
+ * Funzione GLOBALE che scrive su uno stream i valori di [first, last) che soddisfano
+ * un predicato, ciascuno seguito dal separatore.
+ *
+ * I valori sono formattati con le impostazioni di os (`copyfmt`) in un buffer di 64KB
+ * che viene riversato su os a blocchi: os non viene mai svuotato (nessun `std::endl`).
+ *
+ * @tparam Iter Il tipo degli iteratori di input.
+ * @tparam P Il tipo del predicato da utilizzare per filtrare gli elementi.
+ * @param os Lo stream di output su cui scrivere i valori.
+ * @param first L'inizio della sequenza.
+ * @param last La fine della sequenza.
+ * @param pred Il predicato da utilizzare per filtrare gli elementi.
+ * @param sep Il carattere scritto dopo ogni valore.
+ * @return Lo stream di output.
+ */
+template <typename Iter, typename P>
+std::ostream &write_buffered(std::ostream &os, Iter first, Iter last, P pred, char sep = ' ')
+{
+    if (first == last || !os.good())
+        return os;
+    bst_output_buffer buffer(os);
+    std::ostream out(&buffer);
+    out.copyfmt(os);
+    out.tie(nullptr);
+    out.exceptions(std::ios_base::goodbit);
+    for (; first != last && out.good(); ++first)
+        if (pred(*first))
+            out << *first << sep;
+    out.flush();
+    return os;
+}
+
+/**
+ * @brief Classe base delle viste sui `bst`.
+ *
+ * Con le range di C++20 coincide con `std::ranges::view_base`, così le viste
+ * si compongono con gli adattatori di `std::views`.
+ */
+#ifdef __cpp_lib_ranges
+typedef std::ranges::view_base bst_view_base;
+#else
+struct bst_view_base
+{
+};
+#endif
+
+/**
+ * @brief Vista pigra sui valori di una sequenza che soddisfano un predicato.
+ *
+ * Non copia né alloca nulla: il predicato viene valutato durante l'iterazione,
+ * una volta per ogni valore attraversato. Resta valida finché lo è la sequenza
+ * sottostante; gli iteratori restano validi finché esiste la vista.
+ *
+ * Esempio: `for (int v : b.filter(is_even)) ...`
+ *
+ * @tparam Iter Il tipo degli iteratori (almeno forward) della sequenza.
+ * @tparam P Il tipo del predicato.
+ */
+template <typename Iter, typename P>
+class bst_filter_view : public bst_view_base
+{
+public:
+    /**
+     * Iteratore della vista: salta i valori che non soddisfano il predicato.
+     */
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename std::iterator_traits<Iter>::value_type value_type;
+        typedef typename std::iterator_traits<Iter>::difference_type difference_type;
+        typedef typename std::iterator_traits<Iter>::pointer pointer;
+        typedef typename std::iterator_traits<Iter>::reference reference;
+
+        /**
+         * @brief Costruttore di default.
+         */
+        const_iterator() : _pred(nullptr) {}
+
+        reference operator*() const
+        {
+            return *_cur;
+        }
+
+        pointer operator->() const
+        {
+            return &*_cur;
+        }
+
+        const_iterator &operator++()
+        {
+            ++_cur;
+            skip();
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        friend bool operator==(const const_iterator &a, const const_iterator &b)
+        {
+            return a._cur == b._cur;
+        }
+
+        friend bool operator!=(const const_iterator &a, const const_iterator &b)
+        {
+            return !(a == b);
+        }
+
+    private:
+        Iter _cur;      //< posizione corrente nella sequenza
+        Iter _end;      //< fine della sequenza
+        const P *_pred; //< predicato della vista
+
+        friend class bst_filter_view;
+
+        const_iterator(Iter cur, Iter end, const P *pred) : _cur(cur), _end(end), _pred(pred)
+        {
+            skip();
+        }
+
+        /**
+         * @brief Avanza fino al primo valore che soddisfa il predicato.
+         */
+        void skip()
+        {
+            while (_cur != _end && !(*_pred)(*_cur))
+                ++_cur;
+        }
+    };
+
+    typedef const_iterator iterator;
+
+    /**
+     * @brief Costruttore di default: vista vuota.
+     */
+    bst_filter_view() {}
+
+    /**
+     * @brief Costruttore.
+     *
+     * @param first L'inizio della sequenza.
+     * @param last La fine della sequenza.
+     * @param pred Il predicato da utilizzare per filtrare gli elementi.
+     */
+    bst_filter_view(Iter first, Iter last, P pred) : _first(first), _last(last), _pred(std::move(pred)) {}
+
+    bst_filter_view(const bst_filter_view &other) = default;
+    bst_filter_view(bst_filter_view &&other) = default;
+
+    /**
+     * @brief Operatore di assegnazione, disponibile anche se P non è assegnabile (lambda).
+     *
+     * @param other La vista da assegnare.
+     * @return Un riferimento a se stessa.
+     */
+    bst_filter_view &operator=(const bst_filter_view &other)
+    {
+        if (this != &other)
+        {
+            _first = other._first;
+            _last = other._last;
+            _pred.reset();
+            if (other._pred)
+                _pred.emplace(*other._pred);
+        }
+        return *this;
+    }
+
+    bst_filter_view &operator=(bst_filter_view &&other)
+    {
+        if (this != &other)
+        {
+            _first = other._first;
+            _last = other._last;
+            _pred.reset();
+            if (other._pred)
+                _pred.emplace(std::move(*other._pred));
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Restituisce un iteratore al primo valore che soddisfa il predicato.
+     *
+     * Costa quanto scorrere i valori che lo precedono.
+     */
+    const_iterator begin() const
+    {
+        if (!_pred)
+            return const_iterator();
+        return const_iterator(_first, _last, &*_pred);
+    }
+
+    /**
+     * @brief Restituisce un iteratore alla fine della vista.
+     */
+    const_iterator end() const
+    {
+        if (!_pred)
+            return const_iterator();
+        return const_iterator(_last, _last, &*_pred);
+    }
+
+    /**
+     * @brief Indica se nessun valore soddisfa il predicato.
+     */
+    bool empty() const
+    {
+        return begin() == end();
+    }
+
+    /**
+     * Funzione GLOBALE che implementa l'operatore di stream, con scrittura bufferizzata.
+     *
+     * @param os Lo stream di output su cui stampare i valori.
+     * @param v La vista da stampare.
+     * @return Lo stream di output su cui sono stati stampati i valori.
+     */
+    friend std::ostream &operator<<(std::ostream &os, const bst_filter_view &v)
+    {
+        if (v._pred)
+            write_buffered(os, v._first, v._last, *v._pred);
+        return os;
+    }
+
+private:
+    Iter _first;            //< inizio della sequenza
+    Iter _last;             //< fine della sequenza
+    std::optional<P> _pred; //< predicato (assente solo nella vista di default)
+};
+
+/**
+ * @brief Implementazione di un albero binario di ricerca.
+ *
+ * La classe `bst` implementa un albero binario di ricerca, in cui ogni nodo contiene un valore di tipo `T`.
+ * L'ordine dei nodi è determinato dalla funzione di confronto `Comp` e dalla funzione di uguaglianza `Equal`.
+ * L'albero supporta operazioni come l'aggiunta di un nodo, la ricerca di un valore e la stampa degli elementi.
+ *
+ * @tparam T Il tipo di valore contenuto nei nodi dell'albero.
+ * @tparam Comp Il tipo di funzione di confronto per ordinare i nodi.
+ * @tparam Equal Il tipo di funzione di uguaglianza per confrontare i valori dei nodi
+ *               (di default ricavata da `Comp`, vedi `bst_equivalent`).
+ * @tparam Balance La policy di bilanciamento (`bst_unbalanced`, `bst_avl` o `bst_splay`).
+ * @tparam Augment Le informazioni aggiuntive nei nodi (`bst_no_augment`, `bst_order_statistics`,
+ *                 `bst_threaded` o `bst_threaded_order_statistics`).
+ * @tparam Stats La policy di strumentazione (`bst_no_stats` o `bst_counting_stats`).
+ * @tparam Alloc L'allocatore, riassociato ai blocchi di nodi del pool (vedi `pmr_bst`).
+ */
+template <typename T, typename Comp, typename Equal = bst_equivalent<Comp>, typename Balance = bst_unbalanced,
+          typename Augment = bst_no_augment, typename Stats = bst_no_stats, typename Alloc = std::allocator<T>>
+class bst
+{
+    /**
+     * @brief Struttura che rappresenta un nodo di un albero binario di ricerca.
+     *
+     * Le informazioni richieste dalla policy di bilanciamento e dall'aumento sono ereditate
+     * da `Balance::node_meta` e `Augment::node_meta`.
+     *
+     * @tparam T Il tipo di dato contenuto nel nodo.
+     */
+    struct node : public Balance::node_meta, public Augment::node_meta
+    {
+        T value;      //< valore del nodo
+        node *left;   //< puntatore al nodo figlio sinistro
+        node *right;  //< puntatore al nodo figlio destro
+        node *parent; //< puntatore al nodo genitore
+
+        /**
+         * @brief Costruttore di default della struttura node.
+         *
+         * @post left == nullptr
+         * @post right == nullptr
+         * @post parent == nullptr
+         */
+        node() : left(nullptr), right(nullptr), parent(nullptr) {};
+
+        /**
+         * @brief Costruttore della struttura node.
+         *
+         * @param v Il valore del nodo.
+         * @param l Il puntatore al nodo figlio sinistro.
+         * @param r Il puntatore al nodo figlio destro.
+         * @param p Il puntatore al nodo genitore.
+         *
+         * @post value == v
+         * @post left == l
+         * @post right == r
+         * @post parent == p
+         */
+        node(const T &v, node *l, node *r, node *p) : value(v), left(l), right(r), parent(p) {};
+
+        /**
+         * @brief Costruttore della struttura node.
+         *
+         * @param v Il valore del nodo.
+         *
+         * @post value == v
+         * @post left == nullptr
+         * @post right == nullptr
+         * @post parent == nullptr
+         */
+        node(const T &v) : value(v), left(nullptr), right(nullptr), parent(nullptr) {};
+
+        /**
+         * @brief Costruttore della struttura node che sposta il valore.
+         *
+         * @param v Il valore del nodo, da cui vengono spostate le risorse.
+         *
+         * @post left == nullptr
+         * @post right == nullptr
+         * @post parent == nullptr
+         */
+        node(T &&v) : value(std::move(v)), left(nullptr), right(nullptr), parent(nullptr) {};
+
+        /**
+         * @brief Costruttore della struttura node che costruisce il valore sul posto.
+         *
+         * @param args Gli argomenti passati al costruttore di `T`.
+         *
+         * @post left == nullptr
+         * @post right == nullptr
+         * @post parent == nullptr
+         */
+        template <typename... Args>
+        node(std::in_place_t, Args &&...args)
+            : value(std::forward<Args>(args)...), left(nullptr), right(nullptr), parent(nullptr) {};
+    };
+
+    /**
+     * @brief Pool di nodi posseduto dall'albero.
+     *
+     * I nodi vengono ritagliati da blocchi contigui (slab) di dimensione crescente,
+     * invece di essere allocati uno per volta con `new`. I nodi rimossi finiscono in una
+     * free list e vengono riutilizzati; tutti i blocchi sono liberati in un colpo solo
+     * da `release()`.
+     *
+     * I blocchi appartengono a un'arena condivisa tramite `std::shared_ptr`. Quando `split`
+     * o `join` spostano nodi da un albero all'altro senza copiarli, il pool di destinazione
+     * prende un riferimento all'arena di origine, che viene liberata quando nessun pool
+     * la usa più. Ogni pool alloca nuovi blocchi solo nella propria arena.
+     *
+     * Blocchi e arene sono allocati con `Alloc`, riassociato ai rispettivi tipi. Ogni arena
+     * conserva una copia dell'allocatore con cui ha allocato i propri blocchi e la usa per
+     * liberarli, anche quando è passata a un altro albero. Solo l'elenco delle arene condivise,
+     * che si riempie con `split` e `join`, usa l'allocatore standard: così i pool si possono
+     * scambiare anche quando i loro allocatori sono diversi.
+     */
+    class node_pool
+    {
+        /**
+         * @brief Cella di memoria grande e allineata quanto un nodo.
+         *
+         * Quando la cella è libera contiene il puntatore alla cella libera successiva.
+         * La prima cella di ogni blocco ospita invece l'intestazione del blocco.
+         */
+        union slot
+        {
+            slot *next;
+            alignas(node) unsigned char storage[sizeof(node)];
+        };
+
+        /**
+         * @brief Intestazione di un blocco, memorizzata nella sua prima cella.
+         */
+        struct slab_header
+        {
+            slot *next;        //< blocco allocato in precedenza
+            std::size_t cells; //< celle del blocco, intestazione compresa
+        };
+
+        typedef std::allocator_traits<Alloc> alloc_traits;
+        typedef typename alloc_traits::template rebind_alloc<slot> slot_allocator;
+
+        static_assert(sizeof(slab_header) <= sizeof(slot), "slab_header deve stare in una cella");
+
+        /**
+         * @brief Insieme di blocchi liberati tutti insieme quando l'ultimo pool che li usa li rilascia.
+         */
+        struct arena
+        {
+            slot *slabs;          //< lista dei blocchi allocati
+            slot_allocator alloc; //< allocatore dei blocchi
+
+            explicit arena(const slot_allocator &a) : slabs(nullptr), alloc(a) {}
+
+            arena(const arena &) = delete;
+            arena &operator=(const arena &) = delete;
+
+            ~arena()
+            {
+                while (slabs != nullptr)
+                {
+                    slot *s = slabs;
+                    slab_header *h = reinterpret_cast<slab_header *>(s);
+                    slabs = h->next;
+                    std::allocator_traits<slot_allocator>::deallocate(alloc, s, h->cells);
+                }
+            }
+        };
+
+        typedef std::shared_ptr<arena> arena_ptr;
+        typedef std::vector<arena_ptr> arena_list;
+
+        static constexpr std::size_t first_slab = 16; //< celle del primo blocco
+        static constexpr std::size_t max_slab = 4096; //< celle massime di un blocco
+
+        std::optional<slot_allocator> _alloc; //< allocatore delle nuove arene (sempre presente; gli allocatori
+                                              //< come `std::pmr::polymorphic_allocator` non sono assegnabili)
+        arena_ptr _arena;                     //< arena in cui questo pool alloca i blocchi
+        arena_list _shared;                   //< arene di altri pool che contengono nodi di questo
+        slot *_free;                          //< lista delle celle libere
+        slot *_next;                          //< prossima cella mai usata del blocco corrente
+        slot *_end;                           //< fine del blocco corrente
+        std::size_t _capacity;                //< celle totali allocate
+
+        /**
+         * @brief Alloca un nuovo blocco con n celle utilizzabili e lo rende il blocco corrente.
+         *
+         * @param n Il numero di celle utilizzabili del blocco.
+         *
+         * @throw Eccezione generata dall'allocatore se l'allocazione fallisce.
+         */
+        void grow(std::size_t n)
+        {
+            if (_arena == nullptr)
+                _arena = std::allocate_shared<arena>(typename alloc_traits::template rebind_alloc<arena>(*_alloc), *_alloc);
+            slot *s = std::allocator_traits<slot_allocator>::allocate(_arena->alloc, n + 1);
+            slab_header *h = ::new (static_cast<void *>(s)) slab_header;
+            h->next = _arena->slabs;
+            h->cells = n + 1;
+            _arena->slabs = s;
+            _next = s + 1;
+            _end = s + 1 + n;
+            _capacity += n;
+        }
+
+        /**
+         * @brief Aggiunge a shared un riferimento ad a, se non è nullo e non è già presente.
+         *
+         * @param shared Le arene condivise di un pool.
+         * @param own L'arena propria dello stesso pool.
+         * @param a L'arena da aggiungere.
+         */
+        static void add_arena(arena_list &shared, const arena_ptr &own, const arena_ptr &a)
+        {
+            if (a != nullptr && a != own && std::find(shared.begin(), shared.end(), a) == shared.end())
+                shared.push_back(a);
+        }
+
+    public:
+        explicit node_pool(const Alloc &alloc)
+            : _alloc(alloc), _free(nullptr), _next(nullptr), _end(nullptr), _capacity(0) {}
+
+        node_pool(const node_pool &) = delete;
+        node_pool &operator=(const node_pool &) = delete;
+
+        ~node_pool()
+        {
+            release();
+        }
+
+        /**
+         * @brief Restituisce la memoria per un nodo (non costruito).
+         *
+         * @return Puntatore a memoria grande e allineata quanto un nodo.
+         *
+         * @throw std::bad_alloc se l'allocazione di un nuovo blocco fallisce.
+         */
+        void *allocate()
+        {
+            if (_free != nullptr)
+            {
+                slot *s = _free;
+                _free = s->next;
+                return s;
+            }
+            if (_next == _end)
+                grow(std::min(std::max(_capacity, first_slab), max_slab));
+            return _next++;
+        }
+
+        /**
+         * @brief Restituisce al pool la memoria di un nodo già distrutto.
+         *
+         * @param p Il puntatore ottenuto da `allocate()`.
+         */
+        void deallocate(void *p)
+        {
+            slot *s = static_cast<slot *>(p);
+            s->next = _free;
+            _free = s;
+        }
+
+        /**
+         * @brief Garantisce che le prossime n allocazioni siano contigue e non allochino.
+         *
+         * @param n Il numero di nodi da riservare.
+         *
+         * @throw std::bad_alloc se l'allocazione del blocco fallisce.
+         */
+        void reserve(std::size_t n)
+        {
+            if (static_cast<std::size_t>(_end - _next) < n)
+                grow(n);
+        }
+
+        /**
+         * @brief Restituisce la memoria per n nodi consecutivi (non costruiti).
+         *
+         * Il nodo i-esimo si trova a `static_cast<node *>(p) + i`. Le celle non vengono
+         * mai restituite singolarmente alla free list: tornano al sistema con `release()`.
+         *
+         * @param n Il numero di nodi, maggiore di zero.
+         * @return Il puntatore al primo nodo.
+         *
+         * @throw std::bad_alloc se l'allocazione del blocco fallisce.
+         */
+        void *allocate_n(std::size_t n)
+        {
+            static_assert(sizeof(slot) == sizeof(node), "le celle devono essere contigue come un array di nodi");
+            reserve(n);
+            slot *s = _next;
+            _next += n;
+            return s;
+        }
+
+        /**
+         * @brief Rilascia tutti i blocchi. I nodi devono essere già stati distrutti.
+         *
+         * I blocchi vengono liberati subito, a meno che un altro pool non usi ancora la stessa arena.
+         */
+        void release()
+        {
+            _arena.reset();
+            _shared.clear();
+            _free = _next = _end = nullptr;
+            _capacity = 0;
+        }
+
+        /**
+         * @brief Fa sì che other mantenga in vita anche i blocchi di questo pool.
+         *
+         * Da chiamare prima di spostare in other nodi allocati da questo pool.
+         *
+         * @param other Il pool che riceverà i nodi.
+         *
+         * @throw std::bad_alloc se l'allocazione fallisce; in tal caso other resta invariato.
+         */
+        void share_with(node_pool &other) const
+        {
+            arena_list shared(other._shared);
+            add_arena(shared, other._arena, _arena);
+            for (const arena_ptr &a : _shared)
+                add_arena(shared, other._arena, a);
+            other._shared.swap(shared);
+        }
+
+        /**
+         * @brief Scambia il contenuto di due pool.
+         *
+         * @param other Il pool con cui scambiare il contenuto.
+         */
+        void swap(node_pool &other)
+        {
+            slot_allocator alloc(*_alloc);
+            _alloc.emplace(*other._alloc);
+            other._alloc.emplace(alloc);
+            _arena.swap(other._arena);
+            _shared.swap(other._shared);
+            std::swap(_free, other._free);
+            std::swap(_next, other._next);
+            std::swap(_end, other._end);
+            std::swap(_capacity, other._capacity);
+        }
+
+        /**
+         * @brief Restituisce una copia dell'allocatore del pool.
+         *
+         * @return L'allocatore, riassociato a `T`.
+         */
+        Alloc get_allocator() const
+        {
+            return Alloc(*_alloc);
+        }
+    };
+
+    node_pool _pool;      //< pool da cui sono allocati i nodi dell'albero
+    node *_root;          //< puntatore alla radice dell'albero
+    unsigned int _size;   //< numero di nodi dell'albero
+    Comp _compare;        //< funtore per il confronto tra i valori dei nodi
+    Equal _equal;         //< funtore per l'uguaglianza tra i valori dei nodi
+    mutable Stats _stats; //< contatori della policy di strumentazione
+
+    static constexpr std::size_t find_many_lanes = 16; //< ricerche portate avanti insieme da find_many
+
+    static constexpr std::size_t parallel_grain = 1 << 14; //< elementi minimi per thread nelle operazioni parallele
+
+    static constexpr bool order_statistics = std::is_base_of<bst_order_statistics::node_meta, typename Augment::node_meta>::value; //< i nodi contano il proprio sottoalbero
+
+    static constexpr bool threaded = std::is_base_of<bst_threaded::node_meta, typename Augment::node_meta>::value; //< i nodi sono collegati in ordine
+
+    /**
+     * @brief Vale true se Args è un solo argomento di tipo `T` (a meno di riferimenti e const).
+     */
+    template <typename... Args>
+    struct is_value : std::false_type
+    {
+    };
+
+    template <typename A>
+    struct is_value<A> : std::is_same<typename std::decay<A>::type, T>
+    {
+    };
+
+    /**
+     * @brief Confronta due valori con `Comp`, registrando il confronto nella policy `Stats`.
+     *
+     * @param a Il primo valore.
+     * @param b Il secondo valore.
+     * @return True se a precede b.
+     */
+    template <typename A, typename B>
+    bool is_less(const A &a, const B &b) const
+    {
+        _stats.compare();
+        return _compare(a, b);
+    }
+
+    /**
+     * @brief Confronta due valori con `Equal`, registrando il confronto nella policy `Stats`.
+     *
+     * @param a Il primo valore.
+     * @param b Il secondo valore.
+     * @return True se a e b sono uguali.
+     */
+    template <typename A, typename B>
+    bool is_equal(const A &a, const B &b) const
+    {
+        _stats.compare();
+        return _equal(a, b);
+    }
+
+    static constexpr bool derived_equal = bst_derived_equal<Comp, Equal>::value; //< Equal è l'equivalenza indotta da Comp
+
+    template <typename B>
+    struct is_splay : std::false_type
+    {
+    };
+
+    template <unsigned int D>
+    struct is_splay<bst_splay<D>> : std::true_type
+    {
+    };
+
+    static constexpr bool splaying = is_splay<Balance>::value; //< gli accessi portano i nodi alla radice
+
+    template <typename C>
+    struct is_std_less : std::false_type
+    {
+    };
+
+    template <typename X>
+    struct is_std_less<std::less<X>> : std::true_type
+    {
+    };
+
+    /**
+     * @brief Vale true se una chiave di tipo K si confronta con i valori con un solo `<=>` per nodo.
+     *
+     * Richiede C++20, l'uguaglianza ricavata dal confronto e `Comp` uguale a `std::less`.
+     */
+    template <typename K>
+    static constexpr bool three_way()
+    {
+#ifdef __cpp_lib_three_way_comparison
+        if constexpr (derived_equal && is_std_less<Comp>::value)
+            return std::three_way_comparable_with<K, T>;
+        else
+            return false;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Confronta una chiave con un valore, in un solo passo quando possibile.
+     *
+     * Con `<=>` disponibile (vedi `three_way`) fa un solo confronto, altrimenti
+     * ricorre a `Equal` e `Comp`.
+     *
+     * @param key La chiave.
+     * @param value Il valore del nodo.
+     * @return Un numero negativo, zero o positivo se key precede, è uguale o segue value.
+     */
+    template <typename K>
+    int order(const K &key, const T &value) const
+    {
+#ifdef __cpp_lib_three_way_comparison
+        if constexpr (three_way<K>())
+        {
+            _stats.compare();
+            auto c = key <=> value;
+            return c < 0 ? -1 : (c > 0 ? 1 : 0);
+        }
+        else
+#endif
+        if constexpr (derived_equal)
+            return is_less(key, value) ? -1 : (is_less(value, key) ? 1 : 0);
+        else
+            return is_equal(key, value) ? 0 : (is_less(key, value) ? -1 : 1);
+    }
+
+    /**
+     * @brief Crea un nuovo nodo nel pool dell'albero.
+     *
+     * @param args Gli argomenti passati al costruttore del nodo (il valore, oppure
+     *             `std::in_place` seguito dagli argomenti del costruttore di `T`).
+     * @return Il puntatore al nuovo nodo.
+     *
+     * @throw Eccezione generata dall'allocazione o dalla costruzione del valore;
+     *        in tal caso il pool resta invariato.
+     */
+    template <typename... Args>
+    node *create_node(Args &&...args)
+    {
+        void *mem = _pool.allocate();
+        try
+        {
+            node *n = new (mem) node(std::forward<Args>(args)...);
+            _stats.allocate(1);
+            return n;
+        }
+        catch (...)
+        {
+            _pool.deallocate(mem);
+            throw;
+        }
+    }
+
+    /**
+     * @brief Distrugge un nodo e ne restituisce la memoria al pool.
+     *
+     * @param n Il nodo da distruggere.
+     */
+    void destroy_node(node *n)
+    {
+        n->~node();
+        _pool.deallocate(n);
+        _stats.deallocate(1);
+    }
+
+    /**
+     * @brief Restituisce il nodo con il valore minimo del sottoalbero radicato in n.
+     *
+     * @param n La radice del sottoalbero, non nulla.
+     * @return Il nodo più a sinistra del sottoalbero.
+     */
+    static node *leftmost(node *n)
+    {
+        while (n->left != nullptr)
+            n = n->left;
+        return n;
+    }
+
+    /**
+     * @brief Versione costante di `leftmost`.
+     *
+     * @param n La radice del sottoalbero, non nulla.
+     * @return Il nodo più a sinistra del sottoalbero.
+     */
+    static const node *leftmost(const node *n)
+    {
+        while (n->left != nullptr)
+            n = n->left;
+        return n;
+    }
+
+    /**
+     * @brief Restituisce il successore in ordine di n senza uscire dal sottoalbero radicato in top.
+     *
+     * @param n Il nodo di partenza, non nullo.
+     * @param top La radice del sottoalbero da visitare (nullptr per l'intero albero).
+     * @return Il successore di n, oppure nullptr se n è l'ultimo nodo del sottoalbero.
+     */
+    static node *successor(node *n, const node *top)
+    {
+        if (n->right != nullptr)
+            return leftmost(n->right);
+        while (n != top && n->parent != nullptr && n->parent->right == n)
+            n = n->parent;
+        return n == top ? nullptr : n->parent;
+    }
+
+    /**
+     * @brief Restituisce il nodo con il valore massimo del sottoalbero radicato in n.
+     *
+     * @param n La radice del sottoalbero, non nulla.
+     * @return Il nodo più a destra del sottoalbero.
+     */
+    static node *rightmost(node *n)
+    {
+        while (n->right != nullptr)
+            n = n->right;
+        return n;
+    }
+
+    /**
+     * @brief Versione costante di `rightmost`.
+     *
+     * @param n La radice del sottoalbero, non nulla.
+     * @return Il nodo più a destra del sottoalbero.
+     */
+    static const node *rightmost(const node *n)
+    {
+        while (n->right != nullptr)
+            n = n->right;
+        return n;
+    }
+
+    /**
+     * @brief Restituisce il predecessore in ordine di n senza uscire dal sottoalbero radicato in top.
+     *
+     * @param n Il nodo di partenza, non nullo.
+     * @param top La radice del sottoalbero da visitare (nullptr per l'intero albero).
+     * @return Il predecessore di n, oppure nullptr se n è il primo nodo del sottoalbero.
+     */
+    static const node *predecessor(const node *n, const node *top)
+    {
+        if (n->left != nullptr)
+            return rightmost(n->left);
+        while (n != top && n->parent != nullptr && n->parent->left == n)
+            n = n->parent;
+        return n == top ? nullptr : n->parent;
+    }
+
+    /**
+     * @brief Restituisce il successore memorizzato nel nodo (richiede `bst_threaded`).
+     */
+    static node *next_of(const node *n)
+    {
+        return static_cast<node *>(n->next);
+    }
+
+    /**
+     * @brief Restituisce il predecessore memorizzato nel nodo (richiede `bst_threaded`).
+     */
+    static node *prev_of(const node *n)
+    {
+        return static_cast<node *>(n->prev);
+    }
+
+    /**
+     * @brief Collega due nodi consecutivi in ordine (richiede `bst_threaded`).
+     *
+     * @param a Il nodo precedente, oppure nullptr.
+     * @param b Il nodo successivo, oppure nullptr.
+     */
+    static void link_thread(node *a, node *b)
+    {
+        if (a != nullptr)
+            a->next = b;
+        if (b != nullptr)
+            b->prev = a;
+    }
+
+    /**
+     * @brief Inserisce n tra due nodi consecutivi in ordine (richiede `bst_threaded`).
+     *
+     * @param a Il futuro predecessore di n, oppure nullptr.
+     * @param n Il nodo da inserire.
+     * @param b Il futuro successore di n, oppure nullptr.
+     */
+    static void link_thread(node *a, node *n, node *b)
+    {
+        n->prev = a;
+        n->next = b;
+        if (a != nullptr)
+            a->next = n;
+        if (b != nullptr)
+            b->prev = n;
+    }
+
+    /**
+     * @brief Ricostruisce i collegamenti in ordine di tutto l'albero in O(n).
+     *
+     * Usata dopo le costruzioni in blocco; non fa nulla senza l'aumento `bst_threaded`.
+     */
+    void thread_nodes()
+    {
+        if constexpr (threaded)
+        {
+            node *prev = nullptr;
+            for (node *curr = _root == nullptr ? nullptr : leftmost(_root); curr != nullptr; curr = successor(curr, nullptr))
+            {
+                curr->prev = prev;
+                if (prev != nullptr)
+                    prev->next = curr;
+                prev = curr;
+            }
+            if (prev != nullptr)
+                prev->next = nullptr;
+        }
+    }
+
+    /**
+     * @brief Conta i nodi del sottoalbero radicato in n.
+     *
+     * @param n La radice del sottoalbero.
+     * @return Il numero di nodi del sottoalbero.
+     */
+    static unsigned int count_nodes(node *n)
+    {
+        unsigned int count = 0;
+        for (node *curr = n == nullptr ? nullptr : leftmost(n); curr != nullptr; curr = successor(curr, n))
+            ++count;
+        return count;
+    }
+
+    /**
+     * @brief Copia la struttura del sottoalbero radicato in src nell'albero corrente (vuoto).
+     *
+     * Ogni nodo viene copiato una sola volta, senza confronti, mantenendo la forma
+     * dell'originale e le informazioni di bilanciamento. Tutti i nodi sono allocati
+     * in un unico blocco del pool.
+     *
+     * @param src La radice del sottoalbero da copiare.
+     * @param n Il numero di nodi del sottoalbero.
+     *
+     * @throw Eccezione generata dall'allocazione o dalla copia di un valore;
+     *        i nodi già copiati restano collegati all'albero corrente.
+     */
+    void copy_structure(const node *src, unsigned int n)
+    {
+        if (src == nullptr)
+            return;
+        _pool.reserve(n);
+        _root = clone_node(src, nullptr);
+        _size = 1;
+        node *dst = _root;
+        while (true)
+        {
+            if (src->left != nullptr && dst->left == nullptr)
+            {
+                dst->left = clone_node(src->left, dst);
+                src = src->left;
+                dst = dst->left;
+                _size++;
+            }
+            else if (src->right != nullptr && dst->right == nullptr)
+            {
+                dst->right = clone_node(src->right, dst);
+                src = src->right;
+                dst = dst->right;
+                _size++;
+            }
+            else if (dst == _root)
+                break;
+            else
+            {
+                src = src->parent;
+                dst = dst->parent;
+            }
+        }
+        thread_nodes();
+    }
+
+    /**
+     * @brief Crea la copia di un singolo nodo, senza figli.
+     *
+     * @param src Il nodo da copiare.
+     * @param parent Il genitore della copia.
+     * @return La copia del nodo.
+     */
+    node *clone_node(const node *src, node *parent)
+    {
+        node *n = create_node(src->value);
+        static_cast<typename Balance::node_meta &>(*n) = *src;
+        static_cast<typename Augment::node_meta &>(*n) = *src;
+        n->parent = parent;
+        return n;
+    }
+
+    /**
+     * @brief Verifica se una sequenza è ordinata e ne conta gli elementi distinti.
+     *
+     * Gli elementi uguali consecutivi sono ammessi e vengono contati una sola volta.
+     *
+     * @param begin L'iteratore di inizio della sequenza.
+     * @param end L'iteratore di fine della sequenza.
+     * @param n Il numero di elementi distinti, valido solo se la sequenza è ordinata.
+     * @return True se la sequenza è ordinata secondo `Comp`, altrimenti false.
+     */
+    template <typename Iter>
+    bool sorted_unique_count(Iter begin, Iter end, unsigned int &n) const
+    {
+        n = 0;
+        if (begin == end)
+            return true;
+        n = 1;
+        for (Iter prev = begin, it = std::next(begin); it != end; prev = it, ++it)
+        {
+            if (is_equal(*prev, *it))
+                continue;
+            if (!is_less(*prev, *it))
+                return false;
+            ++n;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Costruisce un albero perfettamente bilanciato con n elementi distinti presi in ordine da it.
+     *
+     * Il sottoalbero sinistro riceve n / 2 elementi, il destro i rimanenti:
+     * nessun confronto con `Comp` viene eseguito. Se Distinct è false gli elementi uguali
+     * consecutivi vengono saltati con `Equal`, altrimenti non viene eseguito alcun confronto.
+     *
+     * @tparam Distinct True se la sequenza è strettamente crescente.
+     * @param it L'iteratore sul prossimo elemento da consumare, avanzato dalla funzione.
+     * @param end L'iteratore di fine della sequenza.
+     * @param n Il numero di elementi distinti da consumare.
+     * @return La radice del sottoalbero costruito (con parent nullo).
+     *
+     * @throw Eccezione generata dall'allocazione o dalla copia di un valore;
+     *        i nodi già costruiti vengono distrutti.
+     */
+    template <bool Distinct, typename Iter>
+    node *build_sorted(Iter &it, Iter end, unsigned int n)
+    {
+        if (n == 0)
+            return nullptr;
+
+        node *left = build_sorted<Distinct>(it, end, n / 2);
+        node *curr;
+        try
+        {
+            curr = create_node(*it);
+        }
+        catch (...)
+        {
+            destroy_tree(left);
+            throw;
+        }
+        curr->left = left;
+        if (left != nullptr)
+            left->parent = curr;
+
+        if (Distinct)
+        {
+            Iter prev = it;
+            ++it;
+            assert(it == end || is_less(*prev, *it));
+            (void)prev;
+        }
+        else
+        {
+            Iter prev = it;
+            for (++it; it != end && is_equal(*prev, *it); ++it)
+                ;
+        }
+
+        try
+        {
+            curr->right = build_sorted<Distinct>(it, end, n - n / 2 - 1);
+        }
+        catch (...)
+        {
+            destroy_tree(curr);
+            throw;
+        }
+        if (curr->right != nullptr)
+            curr->right->parent = curr;
+        update(curr);
+        return curr;
+    }
+
+    /**
+     * @brief Riempie l'albero corrente (vuoto) con n elementi distinti ordinati.
+     *
+     * @tparam Distinct True se la sequenza è strettamente crescente.
+     * @param begin L'iteratore di inizio della sequenza ordinata.
+     * @param end L'iteratore di fine della sequenza ordinata.
+     * @param n Il numero di elementi distinti della sequenza.
+     */
+    template <bool Distinct, typename Iter>
+    void load_sorted(Iter begin, Iter end, unsigned int n)
+    {
+        _pool.reserve(n);
+        _root = build_sorted<Distinct>(begin, end, n);
+        _size = n;
+        thread_nodes();
+    }
+
+    /**
+     * @brief Pezzo di albero visitato da un solo thread: un sottoalbero intero (second == true)
+     *        oppure il solo nodo first (second == false).
+     */
+    typedef std::pair<const node *, bool> piece;
+
+    /**
+     * @brief Restituisce il numero di thread da usare per elaborare n elementi.
+     *
+     * @param threads Il numero di thread richiesto (0 per quelli disponibili sull'hardware).
+     * @param n Il numero di elementi da elaborare.
+     * @return Un numero di thread tra 1 e threads, in modo che ognuno abbia almeno
+     *         `parallel_grain` elementi.
+     */
+    static unsigned int thread_count(unsigned int threads, std::size_t n)
+    {
+        if (threads == 0)
+            threads = std::thread::hardware_concurrency();
+        std::size_t useful = n / parallel_grain + 1;
+        return static_cast<unsigned int>(std::max<std::size_t>(1, std::min<std::size_t>(threads, useful)));
+    }
+
+    /**
+     * @brief Restituisce la profondità a cui dividere l'albero per avere almeno quattro pezzi per thread.
+     *
+     * @param threads Il numero di thread.
+     * @return La profondità di divisione.
+     */
+    static unsigned int split_depth(unsigned int threads)
+    {
+        unsigned int depth = 0;
+        while ((std::size_t(1) << depth) < std::size_t(4) * threads)
+            ++depth;
+        return depth;
+    }
+
+    /**
+     * @brief Esegue task(0), ..., task(tasks - 1) con al più threads thread, compreso il chiamante.
+     *
+     * Ogni thread prende il prossimo compito libero da un contatore condiviso: chi finisce
+     * prima prende altri compiti, quindi pezzi di dimensioni diverse si bilanciano da soli.
+     * Se un compito lancia un'eccezione, i compiti non ancora iniziati vengono saltati e la
+     * prima eccezione viene rilanciata dopo che tutti i thread sono terminati.
+     *
+     * @param tasks Il numero di compiti.
+     * @param threads Il numero massimo di thread.
+     * @param task La funzione da chiamare con l'indice del compito, invocabile da più thread insieme.
+     *
+     * @throw Eccezione generata da un compito o dalla creazione di un thread.
+     */
+    template <typename Task>
+    static void run_parallel(std::size_t tasks, unsigned int threads, const Task &task)
+    {
+        std::atomic<std::size_t> next(0);
+        std::vector<std::exception_ptr> errors(threads);
+        auto worker = [&](unsigned int t)
+        {
+            try
+            {
+                for (std::size_t i = next++; i < tasks; i = next++)
+                    task(i);
+            }
+            catch (...)
+            {
+                errors[t] = std::current_exception();
+                next = tasks;
+            }
+        };
+
+        std::vector<std::thread> workers;
+        try
+        {
+            for (unsigned int t = 1; t < threads && t < tasks; ++t)
+                workers.emplace_back(worker, t);
+        }
+        catch (...)
+        {
+            next = tasks;
+            for (std::thread &w : workers)
+                w.join();
+            throw;
+        }
+        worker(0);
+        for (std::thread &w : workers)
+            w.join();
+        for (const std::exception_ptr &e : errors)
+        {
+            if (e)
+                std::rethrow_exception(e);
+        }
+    }
+
+    /**
+     * @brief Ordina values secondo `Comp` usando threads thread.
+     *
+     * Il vettore viene diviso in threads parti ordinate in parallelo, poi fuse a coppie;
+     * le fusioni dello stesso livello procedono in parallelo.
+     *
+     * @param values I valori da ordinare.
+     * @param threads Il numero di thread.
+     */
+    void parallel_sort(std::vector<T> &values, unsigned int threads) const
+    {
+        auto less = [this](const T &a, const T &b)
+        { return _compare(a, b); };
+        std::size_t parts = threads;
+        std::vector<std::size_t> bounds(parts + 1);
+        for (std::size_t i = 0; i <= parts; ++i)
+            bounds[i] = values.size() * i / parts;
+
+        run_parallel(parts, threads, [&](std::size_t i)
+                     { std::sort(values.begin() + bounds[i], values.begin() + bounds[i + 1], less); });
+        for (std::size_t width = 1; width < parts; width *= 2)
+        {
+            run_parallel((parts + 2 * width - 1) / (2 * width), threads, [&](std::size_t i)
+                         {
+                             std::size_t lo = 2 * i * width;
+                             std::size_t mid = std::min(lo + width, parts);
+                             std::size_t hi = std::min(lo + 2 * width, parts);
+                             std::inplace_merge(values.begin() + bounds[lo], values.begin() + bounds[mid],
+                                                values.begin() + bounds[hi], less);
+                         });
+        }
+    }
+
+    /**
+     * @brief Collega i nodi at(lo), ..., at(hi - 1) in un albero perfettamente bilanciato.
+     *
+     * La forma è la stessa di `build_sorted`: il sottoalbero sinistro riceve (hi - lo) / 2 nodi.
+     * Sotto la profondità depth i sottoalberi si considerano già collegati.
+     *
+     * @tparam At Il tipo della funzione che restituisce il nodo di indice dato.
+     * @param at La funzione che restituisce i nodi, in ordine.
+     * @param lo L'indice del primo nodo.
+     * @param hi L'indice successivo all'ultimo nodo.
+     * @param depth La profondità dei sottoalberi già collegati (-1 per collegare tutto).
+     * @return La radice del sottoalbero (il suo parent non viene modificato).
+     */
+    template <typename At>
+    static node *link_range(const At &at, std::size_t lo, std::size_t hi, unsigned int depth)
+    {
+        if (lo == hi)
+            return nullptr;
+        std::size_t mid = lo + (hi - lo) / 2;
+        node *curr = at(mid);
+        if (depth == 0)
+            return curr;
+        curr->left = link_range(at, lo, mid, depth - 1);
+        curr->right = link_range(at, mid + 1, hi, depth - 1);
+        if (curr->left != nullptr)
+            curr->left->parent = curr;
+        if (curr->right != nullptr)
+            curr->right->parent = curr;
+        update(curr);
+        return curr;
+    }
+
+    /**
+     * @brief Raccoglie, in ordine, gli intervalli dei sottoalberi che `link_range` trova alla profondità depth.
+     *
+     * @param lo L'indice del primo nodo.
+     * @param hi L'indice successivo all'ultimo nodo.
+     * @param depth La profondità a cui fermarsi.
+     * @param ranges Il vettore a cui aggiungere gli intervalli.
+     */
+    static void split_range(std::size_t lo, std::size_t hi, unsigned int depth,
+                            std::vector<std::pair<std::size_t, std::size_t>> &ranges)
+    {
+        if (lo == hi)
+            return;
+        if (depth == 0)
+        {
+            ranges.emplace_back(lo, hi);
+            return;
+        }
+        std::size_t mid = lo + (hi - lo) / 2;
+        split_range(lo, mid, depth - 1, ranges);
+        split_range(mid + 1, hi, depth - 1, ranges);
+    }
+
+    /**
+     * @brief Riempie l'albero corrente (vuoto) con i valori ordinati e distinti di values, in parallelo.
+     *
+     * I nodi vengono presi da un unico blocco del pool: il nodo i-esimo contiene values[i],
+     * quindi ogni thread costruisce e collega i propri nodi senza sincronizzarsi con gli altri.
+     * Solo i primi livelli dell'albero vengono collegati dal thread chiamante.
+     *
+     * @param values I valori, ordinati e distinti; vengono spostati nei nodi.
+     * @param threads Il numero di thread.
+     *
+     * @throw Eccezione generata dall'allocazione o dallo spostamento di un valore;
+     *        i nodi già costruiti vengono distrutti e l'albero resta vuoto.
+     */
+    void parallel_load(std::vector<T> &values, unsigned int threads)
+    {
+        std::size_t n = values.size();
+        if (n == 0)
+            return;
+        node *nodes = static_cast<node *>(_pool.allocate_n(n));
+        _stats.allocate(n);
+
+        std::size_t parts = std::min<std::size_t>(n, std::size_t(4) * threads);
+        std::vector<unsigned char> built(parts, 0);
+        try
+        {
+            run_parallel(parts, threads, [&](std::size_t p)
+                         {
+                             std::size_t lo = n * p / parts, hi = n * (p + 1) / parts, i = lo;
+                             try
+                             {
+                                 for (; i < hi; ++i)
+                                     new (nodes + i) node(std::move(values[i]));
+                             }
+                             catch (...)
+                             {
+                                 while (i > lo)
+                                     nodes[--i].~node();
+                                 throw;
+                             }
+                             built[p] = 1;
+                         });
+        }
+        catch (...)
+        {
+            for (std::size_t p = 0; p < parts; ++p)
+            {
+                for (std::size_t i = n * p / parts, hi = n * (p + 1) / parts; built[p] && i < hi; ++i)
+                    nodes[i].~node();
+            }
+            throw;
+        }
+
+        unsigned int depth = split_depth(threads);
+        std::vector<std::pair<std::size_t, std::size_t>> ranges;
+        split_range(0, n, depth, ranges);
+        auto at = [nodes](std::size_t i)
+        { return nodes + i; };
+        run_parallel(ranges.size(), threads, [&](std::size_t r)
+                     { link_range(at, ranges[r].first, ranges[r].second, -1); });
+        _root = link_range(at, 0, n, depth);
+        _size = static_cast<unsigned int>(n);
+        if constexpr (threaded)
+        {
+            // il nodo i contiene l'i-esimo valore: i collegamenti seguono l'array
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                nodes[i].prev = i == 0 ? nullptr : nodes + i - 1;
+                nodes[i].next = i + 1 == n ? nullptr : nodes + i + 1;
+            }
+        }
+    }
+
+    /**
+     * @brief Divide in ordine il sottoalbero radicato in n in pezzi da visitare in parallelo.
+     *
+     * I nodi dei primi depth livelli diventano pezzi di un solo nodo,
+     * i sottoalberi che si trovano sotto di essi pezzi interi.
+     *
+     * @param n La radice del sottoalbero.
+     * @param depth La profondità a cui fermarsi.
+     * @param pieces Il vettore a cui aggiungere i pezzi.
+     */
+    static void split_pieces(const node *n, unsigned int depth, std::vector<piece> &pieces)
+    {
+        if (n == nullptr)
+            return;
+        if (depth == 0)
+        {
+            pieces.emplace_back(n, true);
+            return;
+        }
+        split_pieces(n->left, depth - 1, pieces);
+        pieces.emplace_back(n, false);
+        split_pieces(n->right, depth - 1, pieces);
+    }
+
+    /**
+     * @brief Chiama f, in ordine, sui valori di un pezzo.
+     *
+     * @param p Il pezzo da visitare.
+     * @param f La funzione da chiamare su ogni valore.
+     */
+    template <typename F>
+    static void visit_piece(const piece &p, F &&f)
+    {
+        if (!p.second)
+        {
+            f(p.first->value);
+            return;
+        }
+        node *top = const_cast<node *>(p.first);
+        for (node *curr = leftmost(top); curr != nullptr; curr = successor(curr, top))
+            f(curr->value);
+    }
+
+    /**
+     * @brief Cerca il nodo che contiene un valore equivalente alla chiave.
+     *
+     * @tparam K Il tipo della chiave, `T` oppure un tipo accettato da un `Comp` trasparente.
+     * @param key La chiave da cercare.
+     * @return Il nodo trovato, oppure nullptr.
+     */
+    template <typename K>
+    node *find_node(const K &key) const
+    {
+        return find_from(_root, key);
+    }
+
+    /**
+     * @brief Cerca il nodo equivalente alla chiave nel sottoalbero radicato in curr.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param curr La radice del sottoalbero in cui cercare.
+     * @param key La chiave da cercare.
+     * @return Il nodo trovato, oppure nullptr.
+     */
+    template <typename K>
+    node *find_from(node *curr, const K &key) const
+    {
+        unsigned int path = 0;
+        if constexpr (derived_equal && !three_way<K>())
+        {
+            // un solo confronto per livello: il candidato è l'ultimo nodo non maggiore della chiave,
+            // che è uguale alla chiave se e solo se non la precede
+            node *candidate = nullptr;
+            while (curr != nullptr)
+            {
+                ++path;
+                if (is_less(key, curr->value))
+                    curr = curr->left;
+                else
+                {
+                    candidate = curr;
+                    curr = curr->right;
+                }
+            }
+            _stats.descent(path);
+            if (candidate != nullptr && is_less(candidate->value, key))
+                candidate = nullptr;
+            return candidate;
+        }
+        else
+        {
+            while (curr != nullptr)
+            {
+                ++path;
+                int c = order(key, curr->value);
+                if (c == 0)
+                    break;
+                curr = c < 0 ? curr->left : curr->right;
+            }
+            _stats.descent(path);
+            return curr;
+        }
+    }
+
+    /**
+     * @brief Cerca il punto in cui inserire un valore.
+     *
+     * @param value Il valore da inserire.
+     * @param parent Il futuro genitore del nuovo nodo (nullptr se l'albero è vuoto).
+     * @param left True se il nuovo nodo sarà il figlio sinistro di parent.
+     * @return True se il valore è già presente (parent e left non sono significativi).
+     */
+    bool find_insert_pos(const T &value, node *&parent, bool &left) const
+    {
+        parent = nullptr;
+        left = false;
+        node *curr = _root;
+        unsigned int path = 0;
+        if constexpr (derived_equal && !three_way<T>())
+        {
+            // come in find_from: si scende fino a una foglia e si controlla solo l'ultimo candidato
+            node *candidate = nullptr;
+            while (curr != nullptr)
+            {
+                parent = curr;
+                ++path;
+                left = is_less(value, curr->value);
+                if (left)
+                    curr = curr->left;
+                else
+                {
+                    candidate = curr;
+                    curr = curr->right;
+                }
+            }
+            _stats.descent(path);
+            return candidate != nullptr && !is_less(candidate->value, value);
+        }
+        else
+        {
+            while (curr != nullptr)
+            {
+                parent = curr;
+                ++path;
+                int c = order(value, curr->value);
+                if (c == 0)
+                {
+                    _stats.descent(path);
+                    return true;
+                }
+                left = c < 0;
+                curr = left ? curr->left : curr->right;
+            }
+            _stats.descent(path);
+            return false;
+        }
+    }
+
+    /**
+     * @brief Collega un nuovo nodo nella posizione trovata da `find_insert_pos`.
+     *
+     * @param temp Il nuovo nodo.
+     * @param parent Il genitore del nuovo nodo (nullptr se l'albero è vuoto).
+     * @param left True se il nuovo nodo è il figlio sinistro di parent.
+     */
+    void attach(node *temp, node *parent, bool left)
+    {
+        temp->parent = parent;
+        if (parent == nullptr)
+            _root = temp;
+        else if (left)
+            parent->left = temp;
+        else
+            parent->right = temp;
+
+        if constexpr (threaded)
+        {
+            if (parent == nullptr)
+                link_thread(nullptr, temp, nullptr);
+            else if (left)
+                link_thread(prev_of(parent), temp, parent);
+            else
+                link_thread(parent, temp, next_of(parent));
+        }
+
+        _size++;
+        rebalance(parent, _root);
+        // con Threshold > 1 l'inserimento si limita a contare un accesso
+        if constexpr (splaying)
+            access(temp);
+    }
+
+    /**
+     * @brief Inserisce un valore, creando il nodo solo se il valore non è già presente.
+     *
+     * @param value Il valore da inserire, copiato o spostato nel nuovo nodo.
+     * @return True se il valore è stato aggiunto, false se era già presente.
+     */
+    template <typename V>
+    bool insert_value(V &&value)
+    {
+        node *parent;
+        bool left;
+        if (find_insert_pos(value, parent, left))
+            return false;
+        attach(create_node(std::forward<V>(value)), parent, left);
+        return true;
+    }
+
+    /**
+     * @brief Rimuove il nodo equivalente alla chiave, se presente.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da rimuovere.
+     * @return Il numero di elementi rimossi (0 oppure 1).
+     */
+    template <typename K>
+    unsigned int erase_key(const K &key)
+    {
+        node *n = find_node(key);
+        if (n == nullptr)
+            return 0;
+        erase_node(n);
+        return 1;
+    }
+
+    /**
+     * @brief Stacca un nodo dall'albero, lo distrugge e ripristina il bilanciamento.
+     *
+     * Se il nodo ha due figli il suo posto viene preso dal successore,
+     * che viene ricollegato senza copiarne il valore.
+     *
+     * @param z Il nodo da rimuovere.
+     */
+    void erase_node(node *z)
+    {
+        node *from;
+        if (z->left != nullptr && z->right != nullptr)
+        {
+            node *y = leftmost(z->right);
+            if (y->parent == z)
+                from = y;
+            else
+            {
+                from = y->parent;
+                replace_child(y, y->right, _root);
+                y->right = z->right;
+                y->right->parent = y;
+            }
+            replace_child(z, y, _root);
+            y->left = z->left;
+            y->left->parent = y;
+        }
+        else
+        {
+            from = z->parent;
+            replace_child(z, z->left != nullptr ? z->left : z->right, _root);
+        }
+        if constexpr (threaded)
+            link_thread(prev_of(z), next_of(z));
+        destroy_node(z);
+        _size--;
+        rebalance(from, _root);
+    }
+
+    /**
+     * @brief Restituisce il primo nodo il cui valore non è minore della chiave.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da confrontare.
+     * @return Il nodo trovato, oppure nullptr.
+     */
+    template <typename K>
+    node *lower_node(const K &key) const
+    {
+        node *result = nullptr;
+        node *curr = _root;
+        unsigned int path = 0;
+        while (curr != nullptr)
+        {
+            ++path;
+            if (!is_less(curr->value, key))
+            {
+                result = curr;
+                curr = curr->left;
+            }
+            else
+                curr = curr->right;
+        }
+        _stats.descent(path);
+        return result;
+    }
+
+    /**
+     * @brief Restituisce il primo nodo il cui valore è maggiore della chiave.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da confrontare.
+     * @return Il nodo trovato, oppure nullptr.
+     */
+    template <typename K>
+    node *upper_node(const K &key) const
+    {
+        node *result = nullptr;
+        node *curr = _root;
+        unsigned int path = 0;
+        while (curr != nullptr)
+        {
+            ++path;
+            if (is_less(key, curr->value))
+            {
+                result = curr;
+                curr = curr->left;
+            }
+            else
+                curr = curr->right;
+        }
+        _stats.descent(path);
+        return result;
+    }
+
+    /**
+     * @brief Copia il sottoalbero con radice nel nodo equivalente alla chiave.
+     *
+     * Il nodo viene individuato con una sola discesa dalla radice.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da cercare.
+     * @return Il sottoalbero copiato, vuoto se la chiave non viene trovata.
+     */
+    template <typename K>
+    bst make_subtree(const K &key) const
+    {
+        node *curr = find_node(key);
+        if (curr == nullptr)
+            return bst(get_allocator());
+        return subtree_view(this, curr).clone();
+    }
+
+    /**
+     * @brief Restituisce l'altezza del sottoalbero radicato in n (0 se n è nullo).
+     *
+     * @param n Il nodo di cui calcolare l'altezza.
+     * @return L'altezza memorizzata nel nodo.
+     */
+    static int height(const node *n)
+    {
+        if constexpr (std::is_same<Balance, bst_avl>::value)
+            return n == nullptr ? 0 : n->height;
+        else
+            return 0;
+    }
+
+    /**
+     * @brief Ricalcola le informazioni di bilanciamento di un nodo a partire dai figli.
+     *
+     * @param n Il nodo da aggiornare.
+     */
+    static void update(node *n)
+    {
+        if constexpr (std::is_same<Balance, bst_avl>::value)
+            n->height = static_cast<unsigned char>(1 + std::max(height(n->left), height(n->right)));
+        if constexpr (order_statistics)
+            n->count = 1 + count(n->left) + count(n->right);
+    }
+
+    /**
+     * @brief Restituisce il numero di nodi del sottoalbero radicato in n (0 se n è nullo).
+     *
+     * Richiede l'aumento `bst_order_statistics`.
+     *
+     * @param n La radice del sottoalbero.
+     * @return Il numero di nodi memorizzato nel nodo.
+     */
+    static unsigned int count(const node *n)
+    {
+        return n == nullptr ? 0 : n->count;
+    }
+
+    /**
+     * @brief Conta gli elementi minori della chiave.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da confrontare.
+     * @return Il numero di elementi minori della chiave.
+     */
+    template <typename K>
+    unsigned int rank_key(const K &key) const
+    {
+        static_assert(order_statistics, "rank richiede l'aumento bst_order_statistics");
+        unsigned int r = 0;
+        unsigned int path = 0;
+        const node *curr = _root;
+        while (curr != nullptr)
+        {
+            ++path;
+            if (is_less(curr->value, key))
+            {
+                r += count(curr->left) + 1;
+                curr = curr->right;
+            }
+            else
+                curr = curr->left;
+        }
+        _stats.descent(path);
+        return r;
+    }
+
+    /**
+     * @brief Sostituisce, nel genitore di old_child, il puntatore a old_child con new_child.
+     *
+     * Se old_child è la radice, new_child diventa la nuova radice.
+     *
+     * @param old_child Il nodo da sostituire.
+     * @param new_child Il nodo che prende il suo posto.
+     * @param root La radice dell'albero (o del sottoalbero staccato) che contiene old_child.
+     */
+    static void replace_child(node *old_child, node *new_child, node *&root)
+    {
+        node *p = old_child->parent;
+        if (p == nullptr)
+            root = new_child;
+        else if (p->left == old_child)
+            p->left = new_child;
+        else
+            p->right = new_child;
+        if (new_child != nullptr)
+            new_child->parent = p;
+    }
+
+    /**
+     * @brief Rotazione a sinistra attorno al nodo x.
+     *
+     * @param x Il nodo attorno a cui ruotare, deve avere un figlio destro.
+     * @param root La radice dell'albero che contiene x.
+     * @return La nuova radice del sottoalbero (l'ex figlio destro di x).
+     */
+    static node *rotate_left(node *x, node *&root)
+    {
+        node *y = x->right;
+        replace_child(x, y, root);
+        x->right = y->left;
+        if (y->left != nullptr)
+            y->left->parent = x;
+        y->left = x;
+        x->parent = y;
+        update(x);
+        update(y);
+        return y;
+    }
+
+    /**
+     * @brief Rotazione a destra attorno al nodo x.
+     *
+     * @param x Il nodo attorno a cui ruotare, deve avere un figlio sinistro.
+     * @param root La radice dell'albero che contiene x.
+     * @return La nuova radice del sottoalbero (l'ex figlio sinistro di x).
+     */
+    static node *rotate_right(node *x, node *&root)
+    {
+        node *y = x->left;
+        replace_child(x, y, root);
+        x->left = y->right;
+        if (y->right != nullptr)
+            y->right->parent = x;
+        y->right = x;
+        x->parent = y;
+        update(x);
+        update(y);
+        return y;
+    }
+
+    /**
+     * @brief Ripristina il bilanciamento risalendo dal nodo n fino alla radice.
+     *
+     * Aggiorna anche le informazioni aggiuntive dei nodi attraversati.
+     * Con la policy `bst_unbalanced` e senza aumenti non fa nulla.
+     *
+     * @param n Il primo nodo da controllare (tipicamente il padre del nodo modificato).
+     * @param root La radice dell'albero (o del sottoalbero staccato) che contiene n.
+     */
+    static void rebalance(node *n, node *&root)
+    {
+        if constexpr (std::is_same<Balance, bst_avl>::value)
+        {
+            while (n != nullptr)
+            {
+                update(n);
+                int factor = height(n->left) - height(n->right);
+                if (factor > 1)
+                {
+                    if (height(n->left->left) < height(n->left->right))
+                        rotate_left(n->left, root);
+                    n = rotate_right(n, root);
+                }
+                else if (factor < -1)
+                {
+                    if (height(n->right->right) < height(n->right->left))
+                        rotate_right(n->right, root);
+                    n = rotate_left(n, root);
+                }
+                n = n->parent;
+            }
+        }
+        else if constexpr (order_statistics)
+        {
+            for (; n != nullptr; n = n->parent)
+                update(n);
+        }
+        else
+        {
+            (void)n;
+            (void)root;
+        }
+    }
+
+    /**
+     * @brief Porta il nodo x alla radice con le rotazioni dello splay.
+     *
+     * Le rotazioni aggiornano le informazioni aggiuntive dei nodi coinvolti; l'ordine
+     * dei nodi, e quindi i collegamenti di `bst_threaded`, non cambia.
+     *
+     * @param x Il nodo da portare alla radice.
+     * @param root La radice dell'albero che contiene x.
+     */
+    static void splay(node *x, node *&root)
+    {
+        while (x->parent != nullptr)
+        {
+            node *p = x->parent;
+            node *g = p->parent;
+            bool x_left = p->left == x;
+            if (g == nullptr)
+            {
+                // zig
+                x_left ? rotate_right(p, root) : rotate_left(p, root);
+            }
+            else if (x_left == (g->left == p))
+            {
+                // zig-zig: prima il nonno, poi il genitore
+                if (x_left)
+                {
+                    rotate_right(g, root);
+                    rotate_right(p, root);
+                }
+                else
+                {
+                    rotate_left(g, root);
+                    rotate_left(p, root);
+                }
+            }
+            else
+            {
+                // zig-zag
+                if (x_left)
+                {
+                    rotate_right(p, root);
+                    rotate_left(g, root);
+                }
+                else
+                {
+                    rotate_left(p, root);
+                    rotate_right(g, root);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Registra l'accesso a un nodo: con la policy `bst_splay` lo porta alla radice
+     *        quando i suoi accessi raggiungono `Balance::threshold`.
+     *
+     * @param n Il nodo raggiunto (anche nullptr).
+     */
+    void access(node *n)
+    {
+        if constexpr (splaying)
+        {
+            if (n == nullptr)
+                return;
+            if constexpr (Balance::threshold > 1)
+            {
+                if (++n->hits < Balance::threshold)
+                    return;
+                n->hits = 0;
+            }
+            splay(n, _root);
+        }
+        else
+            (void)n;
+    }
+
+    /**
+     * @brief Operazioni insiemistiche eseguite da `combine_nodes` e `combine_linear`.
+     */
+    enum set_operation
+    {
+        set_op_union,
+        set_op_intersection,
+        set_op_difference
+    };
+
+    /**
+     * @brief Stacca un sottoalbero dal genitore.
+     *
+     * @param n La radice del sottoalbero (anche nulla).
+     * @return n.
+     */
+    static node *detach(node *n)
+    {
+        if (n != nullptr)
+            n->parent = nullptr;
+        return n;
+    }
+
+    /**
+     * @brief Rende l e r i figli di k e ne aggiorna le informazioni aggiuntive.
+     *
+     * @param k Il nodo genitore.
+     * @param l Il nuovo figlio sinistro (anche nullo).
+     * @param r Il nuovo figlio destro (anche nullo).
+     */
+    static void link_children(node *k, node *l, node *r)
+    {
+        k->left = l;
+        k->right = r;
+        if (l != nullptr)
+            l->parent = k;
+        if (r != nullptr)
+            r->parent = k;
+        update(k);
+    }
+
+    /**
+     * @brief Unisce l'albero l, il nodo k e l'albero r in un solo albero.
+     *
+     * Con la policy `bst_avl` il nodo k viene agganciato lungo il fianco dell'albero più alto,
+     * dove il sottoalbero ha l'altezza dell'altro albero, e poi si ribilancia risalendo:
+     * il costo è O(|h(l) - h(r)| + 1). Con le altre policy k diventa la radice.
+     *
+     * @param l La radice di un albero staccato (anche nulla), con valori minori di k.
+     * @param k Il nodo centrale, staccato.
+     * @param r La radice di un albero staccato (anche nulla), con valori maggiori di k.
+     * @return La radice dell'albero risultante.
+     */
+    static node *join_nodes(node *l, node *k, node *r)
+    {
+        k->parent = nullptr;
+        if constexpr (std::is_same<Balance, bst_avl>::value)
+        {
+            if (height(l) > height(r) + 1)
+            {
+                node *p = l;
+                while (height(p->right) > height(r) + 1)
+                    p = p->right;
+                link_children(k, p->right, r);
+                p->right = k;
+                k->parent = p;
+                rebalance(p, l);
+                return l;
+            }
+            if (height(r) > height(l) + 1)
+            {
+                node *p = r;
+                while (height(p->left) > height(l) + 1)
+                    p = p->left;
+                link_children(k, l, p->left);
+                p->left = k;
+                k->parent = p;
+                rebalance(p, r);
+                return r;
+            }
+        }
+        link_children(k, l, r);
+        return k;
+    }
+
+    /**
+     * @brief Unisce due alberi, con tutti i valori di l minori di quelli di r.
+     *
+     * Il minimo di r viene staccato e usato come nodo centrale di `join_nodes`.
+     *
+     * @param l La radice di un albero staccato (anche nulla).
+     * @param r La radice di un albero staccato (anche nulla).
+     * @return La radice dell'albero risultante.
+     */
+    static node *join_nodes(node *l, node *r)
+    {
+        if (l == nullptr)
+            return r;
+        if (r == nullptr)
+            return l;
+        node *m = leftmost(r);
+        node *from = m->parent;
+        replace_child(m, m->right, r);
+        rebalance(from, r);
+        return join_nodes(l, m, r);
+    }
+
+    /**
+     * @brief Divide l'albero radicato in t in base a una chiave.
+     *
+     * Scende fino alla chiave, poi risale con i puntatori al genitore unendo con `join_nodes`
+     * ogni nodo attraversato alla parte già divisa: non c'è ricorsione e, con la policy
+     * `bst_avl`, il costo complessivo è O(log n).
+     *
+     * @tparam K Il tipo della chiave, `T` oppure un tipo accettato da un `Comp` trasparente.
+     * @param t La radice dell'albero, staccato, da dividere.
+     * @param key La chiave.
+     * @param l Riceve la radice dell'albero con i valori minori della chiave.
+     * @param r Riceve la radice dell'albero con i valori maggiori della chiave.
+     * @return Il nodo equivalente alla chiave, staccato e senza figli, oppure nullptr.
+     */
+    template <typename K>
+    node *split_nodes(node *t, const K &key, node *&l, node *&r) const
+    {
+        node *found = nullptr;
+        node *up = nullptr;
+        while (t != nullptr)
+        {
+            if (_equal(key, t->value))
+            {
+                found = t;
+                break;
+            }
+            up = t;
+            t = _compare(key, t->value) ? t->left : t->right;
+        }
+
+        l = r = nullptr;
+        if (found != nullptr)
+        {
+            up = found->parent;
+            l = detach(found->left);
+            r = detach(found->right);
+            found->left = found->right = found->parent = nullptr;
+        }
+        while (up != nullptr)
+        {
+            node *next = up->parent;
+            if (_compare(key, up->value))
+                r = join_nodes(r, up, detach(up->right));
+            else
+                l = join_nodes(detach(up->left), up, l);
+            up = next;
+        }
+        return found;
+    }
+
+    /**
+     * @brief Aggiunge un sottoalbero staccato alla lista dei nodi da distruggere.
+     *
+     * La lista è concatenata tramite il puntatore al genitore delle radici.
+     *
+     * @param n La radice del sottoalbero (anche nulla).
+     * @param garbage La testa della lista.
+     */
+    static void discard(node *n, node *&garbage)
+    {
+        if (n != nullptr)
+        {
+            n->parent = garbage;
+            garbage = n;
+        }
+    }
+
+    /**
+     * @brief Distrugge i sottoalberi della lista creata da `discard`.
+     *
+     * @param garbage La testa della lista.
+     * @return Il numero di nodi distrutti.
+     */
+    unsigned int destroy_discarded(node *garbage)
+    {
+        unsigned int n = 0;
+        while (garbage != nullptr)
+        {
+            node *next = garbage->parent;
+            garbage->parent = nullptr;
+            n += count_nodes(garbage);
+            destroy_tree(garbage);
+            garbage = next;
+        }
+        return n;
+    }
+
+    /**
+     * @brief Esegue left e right, il primo in un nuovo thread se depth è maggiore di zero.
+     *
+     * Ognuna riceve la propria lista di nodi da distruggere; alla fine la lista di left
+     * viene concatenata a garbage. Se il thread non può essere creato, left viene eseguita
+     * dal thread chiamante.
+     *
+     * @param depth Il numero di livelli di ricorsione che possono ancora creare thread.
+     * @param garbage La lista dei nodi da distruggere.
+     * @param left La prima funzione, invocabile con `node *&`.
+     * @param right La seconda funzione, invocabile con `node *&`.
+     */
+    template <typename L, typename R>
+    static void fork_join(unsigned int depth, node *&garbage, const L &left, const R &right)
+    {
+        node *left_garbage = nullptr;
+        std::thread worker;
+        if (depth > 0)
+        {
+            try
+            {
+                worker = std::thread([&left, &left_garbage]()
+                                     { left(left_garbage); });
+            }
+            catch (...)
+            {
+            }
+        }
+        if (!worker.joinable())
+            left(left_garbage);
+        right(garbage);
+        if (worker.joinable())
+            worker.join();
+
+        if (left_garbage != nullptr)
+        {
+            node *tail = left_garbage;
+            while (tail->parent != nullptr)
+                tail = tail->parent;
+            tail->parent = garbage;
+            garbage = left_garbage;
+        }
+    }
+
+    /**
+     * @brief Combina due alberi staccati con split e join.
+     *
+     * L'albero più alto viene diviso con il valore della radice dell'altro, così la ricorsione
+     * segue l'albero più piccolo; le due metà vengono combinate ricorsivamente (in parallelo
+     * nei primi depth livelli) e poi riunite con `join_nodes`.
+     * Con la policy `bst_avl` il costo è O(m log(n / m + 1)), con m ≤ n le dimensioni degli alberi.
+     * Dei valori presenti in entrambi resta il nodo di a.
+     *
+     * Con l'aumento `bst_threaded` i collegamenti in ordine interni a ogni parte restano validi
+     * (split e join non cambiano l'ordine dei nodi): basta ricollegare le parti riunite, al costo
+     * di una discesa lungo il loro fianco. Gli estremi del risultato possono restare collegati a
+     * nodi esterni e vengono azzerati da `combine`.
+     *
+     * @param a La radice del primo albero.
+     * @param b La radice del secondo albero.
+     * @param op L'operazione da eseguire.
+     * @param depth Il numero di livelli di ricorsione che possono creare thread.
+     * @param garbage La lista a cui aggiungere i nodi scartati.
+     * @return La radice del risultato.
+     */
+    node *combine_nodes(node *a, node *b, set_operation op, unsigned int depth, node *&garbage) const
+    {
+        if (a == nullptr || b == nullptr)
+        {
+            node *keep = op == set_op_union ? (a != nullptr ? a : b) : op == set_op_difference ? a : nullptr;
+            if (a != keep)
+                discard(a, garbage);
+            if (b != keep)
+                discard(b, garbage);
+            return keep;
+        }
+
+        unsigned int next = depth > 0 ? depth - 1 : 0;
+        const bool split_a = height(a) > height(b);
+        node *pivot = split_a ? b : a;
+        node *l, *r;
+        node *m = split_a ? split_nodes(a, b->value, l, r) : split_nodes(b, a->value, l, r);
+        node *pl = detach(pivot->left), *pr = detach(pivot->right);
+        pivot->left = pivot->right = nullptr;
+        // gli argomenti restano nell'ordine (parte di a, parte di b)
+        fork_join(depth, garbage, [&](node *&g)
+                  { l = split_a ? combine_nodes(l, pl, op, next, g) : combine_nodes(pl, l, op, next, g); },
+                  [&](node *&g)
+                  { r = split_a ? combine_nodes(r, pr, op, next, g) : combine_nodes(pr, r, op, next, g); });
+
+        // i nodi di a e di b con il valore della radice scelta (uno dei due può mancare)
+        node *in_a = split_a ? m : pivot;
+        node *in_b = split_a ? pivot : m;
+        node *keep;
+        if (op == set_op_union)
+            keep = in_a != nullptr ? in_a : in_b;
+        else if (op == set_op_intersection)
+            keep = in_b != nullptr ? in_a : nullptr;
+        else
+            keep = in_b == nullptr ? in_a : nullptr;
+        if (in_a != keep)
+            discard(in_a, garbage);
+        if (in_b != keep)
+            discard(in_b, garbage);
+        if constexpr (threaded)
+        {
+            node *last = l == nullptr ? nullptr : rightmost(l);
+            node *first = r == nullptr ? nullptr : leftmost(r);
+            if (keep != nullptr)
+                link_thread(last, keep, first);
+            else
+                link_thread(last, first);
+        }
+        return keep != nullptr ? join_nodes(l, keep, r) : join_nodes(l, r);
+    }
+
+    /**
+     * @brief Combina due alberi staccati fondendo le sequenze ordinate dei loro nodi.
+     *
+     * Usata dalle policy senza bilanciamento, dove la ricorsione di `combine_nodes` seguirebbe
+     * l'altezza degli alberi e potrebbe esaurire lo stack. Costa O(n + m) e il risultato
+     * è perfettamente bilanciato. Dei valori presenti in entrambi resta il nodo di a.
+     *
+     * @param a La radice del primo albero.
+     * @param b La radice del secondo albero.
+     * @param op L'operazione da eseguire.
+     * @param garbage La lista a cui aggiungere i nodi scartati.
+     * @return La radice del risultato.
+     *
+     * @throw std::bad_alloc se l'allocazione dei vettori di appoggio fallisce;
+     *        in tal caso gli alberi restano invariati.
+     */
+    node *combine_linear(node *a, node *b, set_operation op, node *&garbage) const
+    {
+        std::vector<node *> xs, ys, out;
+        for (node *curr = a == nullptr ? nullptr : leftmost(a); curr != nullptr; curr = successor(curr, a))
+            xs.push_back(curr);
+        for (node *curr = b == nullptr ? nullptr : leftmost(b); curr != nullptr; curr = successor(curr, b))
+            ys.push_back(curr);
+        out.reserve(xs.size() + ys.size());
+
+        auto drop = [&garbage](node *n)
+        {
+            n->left = n->right = nullptr;
+            discard(n, garbage);
+        };
+        std::size_t i = 0, j = 0;
+        while (i < xs.size() || j < ys.size())
+        {
+            if (j == ys.size() || (i < xs.size() && _compare(xs[i]->value, ys[j]->value)))
+            {
+                if (op == set_op_intersection)
+                    drop(xs[i]);
+                else
+                    out.push_back(xs[i]);
+                ++i;
+            }
+            else if (i == xs.size() || !_equal(xs[i]->value, ys[j]->value))
+            {
+                if (op == set_op_union)
+                    out.push_back(ys[j]);
+                else
+                    drop(ys[j]);
+                ++j;
+            }
+            else
+            {
+                if (op == set_op_difference)
+                    drop(xs[i]);
+                else
+                    out.push_back(xs[i]);
+                drop(ys[j]);
+                ++i;
+                ++j;
+            }
+        }
+
+        if constexpr (threaded)
+        {
+            node *prev = nullptr;
+            for (node *n : out)
+            {
+                link_thread(prev, n);
+                prev = n;
+            }
+            link_thread(prev, nullptr);
+        }
+        node *root = link_range([&out](std::size_t k)
+                                { return out[k]; },
+                                0, out.size(), -1);
+        return detach(root);
+    }
+
+    /**
+     * @brief Combina l'albero corrente con other, che viene svuotato.
+     *
+     * @param other L'altro albero.
+     * @param op L'operazione da eseguire.
+     * @param threads Il numero massimo di thread.
+     */
+    void combine(bst &other, set_operation op, unsigned int threads)
+    {
+        if (this == &other)
+        {
+            if (op == set_op_difference)
+                clear();
+            return;
+        }
+        other._pool.share_with(_pool);
+        unsigned int total = _size + other._size;
+        node *garbage = nullptr;
+        if constexpr (std::is_same<Balance, bst_avl>::value)
+            _root = combine_nodes(_root, other._root, op, split_depth(thread_count(threads, total)) - 2, garbage);
+        else
+            _root = combine_linear(_root, other._root, op, garbage);
+        other._root = nullptr;
+        other._size = 0;
+        other.clear();
+        _size = total - destroy_discarded(garbage);
+        if constexpr (threaded)
+        {
+            if (_root != nullptr)
+            {
+                leftmost(_root)->prev = nullptr;
+                rightmost(_root)->next = nullptr;
+            }
+        }
+    }
+
+    /**
+     * @brief Sposta in un nuovo albero tutti i valori non minori della chiave.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave in cui dividere l'albero.
+     * @return L'albero con i valori non minori della chiave.
+     */
+    template <typename K>
+    bst split_key(const K &key)
+    {
+        bst right(get_allocator());
+        _pool.share_with(right._pool);
+        node *l, *r;
+        node *m = split_nodes(_root, key, l, r);
+        if (m != nullptr)
+            r = join_nodes(nullptr, m, r);
+        if constexpr (order_statistics)
+            right._size = count(r);
+        else
+            right._size = count_nodes(r);
+        right._root = r;
+        _root = l;
+        _size -= right._size;
+        if constexpr (threaded)
+        {
+            if (l != nullptr)
+                rightmost(l)->next = nullptr;
+            if (r != nullptr)
+                leftmost(r)->prev = nullptr;
+        }
+        return right;
+    }
+
+public:
+    /**
+     * @brief Classe che rappresenta un albero binario di ricerca.
+     *
+     * Questa classe implementa un albero binario di ricerca, in cui ogni nodo
+     * contiene un valore e due puntatori ai suoi figli sinistro e destro.
+     *
+     * @post _root == nullptr
+     * @post _size == 0
+     */
+    bst() : bst(Alloc()) {}
+
+    /**
+     * @brief Costruisce un albero vuoto che allocherà i nodi con l'allocatore indicato.
+     *
+     * @param alloc L'allocatore.
+     *
+     * @post _root == nullptr
+     * @post _size == 0
+     */
+    explicit bst(const Alloc &alloc) : _pool(alloc), _root(nullptr), _size(0) {}
+
+    /**
+     * @brief Costruttore della classe bst.
+     *
+     * Questo costruttore crea un nuovo albero binario di ricerca (bst)
+     * con un nodo radice iniziale.
+     *
+     * @param value Il valore del nodo radice.
+     * @param alloc L'allocatore.
+     *
+     * @throw Eccezione standard in caso di errore nella creazione del nodo radice.
+     */
+    bst(const T &value, const Alloc &alloc = Alloc()) : _pool(alloc), _root(nullptr), _size(1)
+    {
+        try
+        {
+            _root = create_node(value);
+        }
+        catch (...)
+        {
+            clear();
+            throw;
+        }
+    };
+
+    /**
+     * @brief Copia ricorsivamente i nodi di un'altra istanza di bst nel bst corrente.
+     *
+     * @param c L'istanza di bst da cui copiare i nodi.
+     * @param root Il nodo radice dell'albero da copiare.
+     *
+     * @throw Eccezione generica se si verifica un errore durante la copia;
+     *        gli elementi già copiati restano in c, che ne è responsabile.
+     */
+    void copyRic(bst &c, const node *root)
+    {
+        if (root != nullptr)
+        {
+            c.add(root->value);
+            copyRic(c, root->left);
+            copyRic(c, root->right);
+        }
+    }
+
+    /**
+     * @brief Copy constructor
+     *
+     * Costruttore di copia della classe bst.
+     * La copia è strutturale: costa O(n) e non esegue confronti.
+     * L'allocatore è quello scelto da `select_on_container_copy_construction`.
+     *
+     * @param other L'albero binario di ricerca da copiare.
+     */
+    bst(const bst &other)
+        : bst(other, std::allocator_traits<Alloc>::select_on_container_copy_construction(other.get_allocator())) {}
+
+    /**
+     * @brief Copia un albero allocando i nodi con l'allocatore indicato.
+     *
+     * @param other L'albero binario di ricerca da copiare.
+     * @param alloc L'allocatore della copia.
+     */
+    bst(const bst &other, const Alloc &alloc) : _pool(alloc), _root(nullptr), _size(0)
+    {
+        try
+        {
+            copy_structure(other._root, other._size);
+        }
+        catch (...)
+        {
+            clear();
+            throw;
+        }
+    }
+
+    /**
+     * @brief Move constructor
+     *
+     * Costruttore di spostamento: prende i nodi di other senza copiarli.
+     *
+     * @param other L'albero da cui spostare i nodi.
+     *
+     * @post other.size() == 0
+     */
+    bst(bst &&other) noexcept : _pool(other.get_allocator()), _root(nullptr), _size(0)
+    {
+        swap(other);
+    }
+
+    /**
+     * @brief Operatore assegnazione per spostamento
+     *
+     * Libera i nodi correnti e prende quelli di other senza copiarli. Se l'allocatore
+     * non si propaga ed è diverso da quello di other, i valori vengono invece copiati
+     * con l'allocatore corrente, come nei contenitori standard.
+     *
+     * @param other L'albero da cui spostare i nodi.
+     * @return reference all'istanza di bst corrente.
+     *
+     * @post other.size() == 0
+     */
+    bst &operator=(bst &&other) noexcept(std::allocator_traits<Alloc>::propagate_on_container_move_assignment::value ||
+                                         std::allocator_traits<Alloc>::is_always_equal::value)
+    {
+        if (this != &other)
+        {
+            typedef std::allocator_traits<Alloc> traits;
+            if constexpr (!traits::propagate_on_container_move_assignment::value && !traits::is_always_equal::value)
+            {
+                if (get_allocator() != other.get_allocator())
+                {
+                    bst tmp(other, get_allocator());
+                    swap(tmp);
+                    other.clear();
+                    return *this;
+                }
+            }
+            clear();
+            swap(other);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Operatore assegnazione
+     *
+     * Questo operatore assegna un'altra istanza di bst all'istanza corrente.
+     *
+     * @param other L'albero binario di ricerca da copiare.
+     * @return reference all'istanza di bst corrente.
+     */
+    bst &operator=(const bst &other)
+    {
+        if (this != &other)
+        {
+            typedef std::allocator_traits<Alloc> traits;
+            bst tmp(other, traits::propagate_on_container_copy_assignment::value ? other.get_allocator() : get_allocator());
+            swap(tmp);
+        }
+
+        return *this;
+    }
+
+    /**
+     * @brief Distruttore della classe bst.
+     *
+     * Questo distruttore si occupa di deallocare tutti i nodi dell'albero binario di ricerca.
+     * La memoria dei nodi viene liberata in blocco dal pool.
+     *
+     * @post _root == nullptr
+     */
+    ~bst()
+    {
+        clear();
+    }
+
+    /**
+     * @brief Costruisce un albero binario di ricerca a partire da una sequenza di elementi.
+     *
+     * Questo costruttore crea un albero binario di ricerca a partire da una sequenza di elementi
+     * definita dall'iteratore di inizio e l'iteratore di fine.
+     * Se gli iteratori permettono più passate e la sequenza risulta già ordinata,
+     * l'albero viene costruito direttamente bilanciato in O(n); altrimenti gli elementi
+     * vengono aggiunti uno alla volta.
+     *
+     * @tparam Iter Il tipo dell'iteratore.
+     * @param begin L'iteratore di inizio della sequenza.
+     * @param end L'iteratore di fine della sequenza.
+     * @param alloc L'allocatore.
+     *
+     * @throw Eccezione generata durante l'inserimento degli elementi.
+     */
+    template <typename Iter>
+    bst(Iter begin, Iter end, const Alloc &alloc = Alloc()) : _pool(alloc), _root(nullptr), _size(0)
+    {
+        try
+        {
+            unsigned int n = 0;
+            if (std::is_base_of<std::forward_iterator_tag,
+                                typename std::iterator_traits<Iter>::iterator_category>::value &&
+                sorted_unique_count(begin, end, n))
+            {
+                load_sorted<false>(begin, end, n);
+            }
+            else
+            {
+                Iter it = begin;
+                for (; it != end; ++it)
+                {
+                    add(*it);
+                }
+            }
+        }
+        catch (...)
+        {
+            clear();
+            throw;
+        }
+    }
+
+    /**
+     * @brief Costruisce un albero bilanciato da una sequenza già ordinata.
+     *
+     * L'albero viene costruito in O(n) senza alcun confronto tra gli elementi:
+     * la sequenza viene percorsa una volta per contarli (in O(1) con iteratori ad
+     * accesso casuale) e una volta per creare i nodi. Per una sequenza che può contenere
+     * duplicati si usa il costruttore da iteratori, che li salta.
+     *
+     * @tparam Iter Il tipo dell'iteratore, almeno forward.
+     * @param begin L'iteratore di inizio della sequenza.
+     * @param end L'iteratore di fine della sequenza.
+     *
+     * @param alloc L'allocatore.
+     *
+     * @pre La sequenza è ordinata in modo strettamente crescente secondo `Comp`.
+     *
+     * @throw Eccezione generata durante la creazione dei nodi.
+     */
+    template <typename Iter>
+    bst(bst_from_sorted_t, Iter begin, Iter end, const Alloc &alloc = Alloc()) : _pool(alloc), _root(nullptr), _size(0)
+    {
+        try
+        {
+            load_sorted<true>(begin, end, static_cast<unsigned int>(std::distance(begin, end)));
+        }
+        catch (...)
+        {
+            clear();
+            throw;
+        }
+    }
+
+    /**
+     * @brief Costruisce un albero bilanciato da una sequenza qualsiasi usando più thread.
+     *
+     * Gli elementi vengono copiati in un vettore, ordinati in parallelo (ordinamento a blocchi
+     * seguito da fusioni a coppie), privati dei duplicati e infine collegati in un albero
+     * perfettamente bilanciato: ogni thread costruisce i nodi di una parte dell'albero.
+     * `Comp` e `Equal` vengono chiamati da più thread insieme.
+     *
+     * @tparam Iter Il tipo dell'iteratore.
+     * @param begin L'iteratore di inizio della sequenza.
+     * @param end L'iteratore di fine della sequenza.
+     * @param threads Il numero massimo di thread (0 per quelli disponibili sull'hardware).
+     * @param alloc L'allocatore dei nodi (il vettore di appoggio usa l'allocatore standard).
+     *
+     * @throw Eccezione generata dall'allocazione, dalla copia dei valori o dalla creazione dei thread.
+     */
+    template <typename Iter>
+    bst(bst_parallel_t, Iter begin, Iter end, unsigned int threads = 0, const Alloc &alloc = Alloc())
+        : _pool(alloc), _root(nullptr), _size(0)
+    {
+        try
+        {
+            std::vector<T> values(begin, end);
+            threads = thread_count(threads, values.size());
+            parallel_sort(values, threads);
+            values.erase(std::unique(values.begin(), values.end(), [this](const T &a, const T &b)
+                                     { return _equal(a, b); }),
+                         values.end());
+            parallel_load(values, threads);
+        }
+        catch (...)
+        {
+            clear();
+            throw;
+        }
+    }
+
+    /**
+     * @brief Aggiunge un valore all'albero binario di ricerca.
+     *
+     * Questo metodo aggiunge un nuovo nodo contenente il valore specificato all'albero binario di ricerca.
+     * Se il valore è già presente nell'albero, il nodo non viene aggiunto.
+     * Il nodo viene allocato solo dopo aver trovato il punto di inserimento,
+     * quindi un duplicato non costa alcuna allocazione.
+     *
+     * @param value Il valore da aggiungere all'albero.
+     *
+     * @throw Eccezione generica se si verifica un errore durante l'aggiunta del nodo;
+     *        in tal caso l'albero resta invariato.
+     */
+    void add(const T &value)
+    {
+        insert_value(value);
+    }
+
+    /**
+     * @brief Aggiunge un valore all'albero binario di ricerca spostandolo nel nuovo nodo.
+     *
+     * Se il valore è già presente nell'albero, value non viene modificato.
+     *
+     * @param value Il valore da aggiungere all'albero.
+     *
+     * @throw Eccezione generica se si verifica un errore durante l'aggiunta del nodo;
+     *        in tal caso l'albero resta invariato.
+     */
+    void add(T &&value)
+    {
+        insert_value(std::move(value));
+    }
+
+    /**
+     * @brief Costruisce un valore direttamente nel nuovo nodo e lo aggiunge all'albero.
+     *
+     * Se l'argomento è un solo valore di tipo `T`, la posizione viene cercata prima e il
+     * nodo viene creato solo se il valore non è un duplicato. Altrimenti il valore viene
+     * costruito nel nodo (senza copie) e, se è un duplicato, distrutto e la memoria del
+     * nodo restituita al pool.
+     *
+     * @param args Gli argomenti passati al costruttore di `T`.
+     * @return True se il valore è stato aggiunto, false se era già presente.
+     *
+     * @throw Eccezione generica se si verifica un errore durante l'aggiunta del nodo;
+     *        in tal caso l'albero resta invariato.
+     */
+    template <typename... Args>
+    bool emplace(Args &&...args)
+    {
+        if constexpr (is_value<Args...>::value)
+            return insert_value(std::forward<Args>(args)...);
+        else
+        {
+            node *temp = create_node(std::in_place, std::forward<Args>(args)...);
+            node *parent;
+            bool left;
+            if (find_insert_pos(temp->value, parent, left))
+            {
+                destroy_node(temp);
+                return false;
+            }
+            attach(temp, parent, left);
+            return true;
+        }
+    }
+
+    /**
+     * @brief Rimuove un valore dall'albero binario di ricerca.
+     *
+     * Se il valore non è presente l'albero resta invariato. Gli iteratori agli altri
+     * elementi restano validi: i nodi vengono ricollegati, non viene spostato alcun valore.
+     *
+     * @param value Il valore da rimuovere.
+     * @return Il numero di elementi rimossi (0 oppure 1).
+     */
+    unsigned int erase(const T &value)
+    {
+        return erase_key(value);
+    }
+
+    /**
+     * @brief Rimuove il valore equivalente a una chiave di tipo diverso da `T`.
+     *
+     * Disponibile solo se `Comp` dichiara `is_transparent` (vedi `find`).
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave del valore da rimuovere.
+     * @return Il numero di elementi rimossi (0 oppure 1).
+     */
+    template <typename K, typename C = Comp, typename = typename C::is_transparent>
+    unsigned int erase(const K &key)
+    {
+        return erase_key(key);
+    }
+
+    /**
+     * @brief Scambia il contenuto di due alberi binari di ricerca.
+     *
+     * Questa funzione scambia il contenuto dell'albero binario di ricerca
+     * corrente con un altro albero binario di ricerca specificato.
+     * Gli allocatori vengono sempre scambiati insieme ai nodi, anche quando sono diversi.
+     *
+     * @param other L'albero binario di ricerca con cui scambiare il contenuto.
+     */
+    void swap(bst &other) noexcept
+    {
+        _pool.swap(other._pool);
+        std::swap(_root, other._root);
+        std::swap(_size, other._size);
+    }
+
+    /**
+     * @brief Restituisce l'allocatore dell'albero.
+     *
+     * @return Una copia dell'allocatore.
+     */
+    Alloc get_allocator() const
+    {
+        return _pool.get_allocator();
+    }
+
+    /**
+     * @brief Sposta in un nuovo albero tutti i valori non minori di value.
+     *
+     * I nodi non vengono copiati: l'albero restituito condivide con quello corrente
+     * i blocchi di memoria del pool, che vengono liberati quando entrambi li hanno rilasciati.
+     * Con la policy `bst_avl` entrambe le parti restano bilanciate e la divisione costa O(log n),
+     * più il conteggio dei nodi spostati se manca l'aumento `bst_order_statistics`.
+     *
+     * @param value Il valore in cui dividere l'albero.
+     * @return L'albero con i valori non minori di value.
+     *
+     * @throw std::bad_alloc se l'allocazione fallisce; in tal caso l'albero resta invariato.
+     */
+    bst split(const T &value)
+    {
+        return split_key(value);
+    }
+
+    /**
+     * @brief Sposta in un nuovo albero tutti i valori non minori della chiave.
+     *
+     * Disponibile solo se `Comp` dichiara `is_transparent`.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave in cui dividere l'albero.
+     * @return L'albero con i valori non minori della chiave.
+     *
+     * @throw std::bad_alloc se l'allocazione fallisce; in tal caso l'albero resta invariato.
+     */
+    template <typename K, typename C = Comp, typename = typename C::is_transparent>
+    bst split(const K &key)
+    {
+        return split_key(key);
+    }
+
+    /**
+     * @brief Aggiunge in coda all'albero tutti i valori di other, senza copiarli.
+     *
+     * Con la policy `bst_avl` costa O(|h1 - h2| + 1) con h1 e h2 le altezze dei due alberi.
+     *
+     * @param other L'albero da aggiungere, svuotato dall'operazione.
+     *
+     * @pre Tutti i valori dell'albero corrente sono minori di tutti i valori di other.
+     *
+     * @throw std::bad_alloc se l'allocazione fallisce; in tal caso gli alberi restano invariati.
+     */
+    void join(bst &&other)
+    {
+        if (this == &other || other._root == nullptr)
+            return;
+        other._pool.share_with(_pool);
+        if constexpr (threaded)
+        {
+            if (_root != nullptr)
+                link_thread(rightmost(_root), leftmost(other._root));
+        }
+        _root = join_nodes(_root, other._root);
+        _size += other._size;
+        other._root = nullptr;
+        other._size = 0;
+        other.clear();
+    }
+
+    /**
+     * @brief Aggiunge all'albero i valori di other, senza copiarli.
+     *
+     * Con la policy `bst_avl` l'albero più piccolo viene usato per dividere ricorsivamente
+     * l'altro con `split` e le metà vengono riunite con `join`: il costo è O(m log(n / m + 1)),
+     * con m ≤ n le dimensioni dei due alberi, e le due metà di ogni livello possono essere
+     * combinate da thread diversi. Con le altre policy le sequenze ordinate vengono fuse
+     * in O(n + m) e il risultato è perfettamente bilanciato.
+     * Dei valori presenti in entrambi gli alberi resta quello dell'albero corrente.
+     *
+     * @param other L'albero da unire, svuotato dall'operazione.
+     * @param threads Il numero massimo di thread (1 per non usarne altri, 0 per quelli
+     *                disponibili sull'hardware).
+     *
+     * @pre `Comp` e `Equal` non lanciano eccezioni.
+     *
+     * @throw std::bad_alloc se l'allocazione fallisce; in tal caso gli alberi restano invariati.
+     */
+    void set_union(bst &&other, unsigned int threads = 1)
+    {
+        combine(other, set_op_union, threads);
+    }
+
+    /**
+     * @brief Aggiunge all'albero una copia dei valori di other.
+     *
+     * Come `set_union(bst &&, unsigned int)`, dopo aver copiato other in O(m).
+     *
+     * @param other L'albero da unire.
+     * @param threads Il numero massimo di thread.
+     */
+    void set_union(const bst &other, unsigned int threads = 1)
+    {
+        set_union(bst(other, get_allocator()), threads);
+    }
+
+    /**
+     * @brief Mantiene nell'albero solo i valori presenti anche in other.
+     *
+     * Costo e parallelismo come `set_union`.
+     *
+     * @param other L'albero con cui intersecare, svuotato dall'operazione.
+     * @param threads Il numero massimo di thread (1 per non usarne altri, 0 per quelli
+     *                disponibili sull'hardware).
+     *
+     * @pre `Comp` e `Equal` non lanciano eccezioni.
+     *
+     * @throw std::bad_alloc se l'allocazione fallisce; in tal caso gli alberi restano invariati.
+     */
+    void set_intersection(bst &&other, unsigned int threads = 1)
+    {
+        combine(other, set_op_intersection, threads);
+    }
+
+    /**
+     * @brief Mantiene nell'albero solo i valori presenti anche in other, che non viene modificato.
+     *
+     * @param other L'albero con cui intersecare.
+     * @param threads Il numero massimo di thread.
+     */
+    void set_intersection(const bst &other, unsigned int threads = 1)
+    {
+        set_intersection(bst(other, get_allocator()), threads);
+    }
+
+    /**
+     * @brief Rimuove dall'albero i valori presenti in other.
+     *
+     * Costo e parallelismo come `set_union`.
+     *
+     * @param other L'albero dei valori da rimuovere, svuotato dall'operazione.
+     * @param threads Il numero massimo di thread (1 per non usarne altri, 0 per quelli
+     *                disponibili sull'hardware).
+     *
+     * @pre `Comp` e `Equal` non lanciano eccezioni.
+     *
+     * @throw std::bad_alloc se l'allocazione fallisce; in tal caso gli alberi restano invariati.
+     */
+    void set_difference(bst &&other, unsigned int threads = 1)
+    {
+        combine(other, set_op_difference, threads);
+    }
+
+    /**
+     * @brief Rimuove dall'albero i valori presenti in other, che non viene modificato.
+     *
+     * @param other L'albero dei valori da rimuovere.
+     * @param threads Il numero massimo di thread.
+     */
+    void set_difference(const bst &other, unsigned int threads = 1)
+    {
+        set_difference(bst(other, get_allocator()), threads);
+    }
+
+    /**
+     * @brief Restituisce la dimensione dell'albero.
+     *
+     * @return La dimensione dell'albero.
+     */
+    unsigned int size() const
+    {
+        return _size;
+    }
+
+    /**
+     * @brief Restituisce i contatori della policy di strumentazione.
+     *
+     * Con `bst_counting_stats` contengono confronti, allocazioni e lunghezza delle discese
+     * (ricerche, inserimenti, rimozioni, limiti e rank) dalla costruzione dell'albero
+     * o dall'ultima `reset_stats()`. Le operazioni parallele e insiemistiche non vengono misurate.
+     *
+     * @return Un riferimento costante ai contatori.
+     */
+    const Stats &stats() const
+    {
+        return _stats;
+    }
+
+    /**
+     * @brief Azzera i contatori della policy di strumentazione.
+     */
+    void reset_stats()
+    {
+        _stats = Stats();
+    }
+
+    /**
+     * @brief Trova un valore nell'albero binario di ricerca.
+     *
+     * Questo metodo cerca un valore specifico nell'albero binario di ricerca.
+     * Restituisce true se il valore viene trovato, altrimenti restituisce false.
+     *
+     * @param value Il valore da cercare nell'albero.
+     * @return True se il valore viene trovato, altrimenti false.
+     */
+    bool find(const T &value) const
+    {
+        return find_node(value) != nullptr;
+    }
+
+    /**
+     * @brief Trova un valore nell'albero a partire da una chiave di tipo diverso da `T`.
+     *
+     * Disponibile solo se `Comp` dichiara `is_transparent`: in tal caso `Comp` e `Equal`
+     * devono accettare la chiave in entrambe le posizioni, ad esempio solo la posizione
+     * di una squadra invece di una `team` completa.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da cercare nell'albero.
+     * @return True se un valore equivalente alla chiave viene trovato, altrimenti false.
+     */
+    template <typename K, typename C = Comp, typename = typename C::is_transparent>
+    bool find(const K &key) const
+    {
+        return find_node(key) != nullptr;
+    }
+
+    /**
+     * @brief Trova un valore e, con la policy `bst_splay`, porta il suo nodo verso la radice.
+     *
+     * Disponibile solo con la policy `bst_splay`; sugli alberi costanti viene usata la
+     * versione costante, che non modifica la forma. Gli iteratori restano validi, mentre
+     * le viste sui sottoalberi possono cambiare contenuto.
+     *
+     * @param value Il valore da cercare nell'albero.
+     * @return True se il valore viene trovato, altrimenti false.
+     */
+    template <typename B = Balance, typename = typename std::enable_if<is_splay<B>::value>::type>
+    bool find(const T &value)
+    {
+        node *n = find_node(value);
+        access(n);
+        return n != nullptr;
+    }
+
+    /**
+     * @brief Versione di `find` per chiavi di tipo diverso da `T` con la policy `bst_splay`.
+     *
+     * Disponibile solo se `Comp` dichiara `is_transparent`.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da cercare nell'albero.
+     * @return True se un valore equivalente alla chiave viene trovato, altrimenti false.
+     */
+    template <typename K, typename C = Comp, typename = typename C::is_transparent, typename B = Balance,
+              typename = typename std::enable_if<is_splay<B>::value>::type>
+    bool find(const K &key)
+    {
+        node *n = find_node(key);
+        access(n);
+        return n != nullptr;
+    }
+
+    /**
+     * @brief Cerca più valori contemporaneamente.
+     *
+     * Le ricerche vengono portate avanti a gruppi di `find_many_lanes`, un livello alla volta
+     * per ciascuna, e il nodo successivo di ogni ricerca viene caricato in anticipo:
+     * così le attese sulla memoria delle diverse ricerche si sovrappongono.
+     *
+     * @param keys L'array dei valori da cercare.
+     * @param count Il numero di valori da cercare.
+     * @param result La bitmap dei risultati, di almeno (count + 63) / 64 parole:
+     *               il bit i è 1 se keys[i] è presente nell'albero.
+     */
+    void find_many(const T *keys, std::size_t count, std::uint64_t *result) const
+    {
+        std::fill(result, result + (count + 63) / 64, std::uint64_t(0));
+
+        const node *lanes[find_many_lanes];
+        for (std::size_t base = 0; base < count; base += find_many_lanes)
+        {
+            std::size_t width = std::min(find_many_lanes, count - base);
+            std::size_t active = width;
+            for (std::size_t i = 0; i < width; ++i)
+                lanes[i] = _root;
+            if (_root == nullptr)
+                continue;
+
+            while (active != 0)
+            {
+                for (std::size_t i = 0; i < width; ++i)
+                {
+                    const node *curr = lanes[i];
+                    if (curr == nullptr)
+                        continue;
+                    const T &key = keys[base + i];
+                    int c = order(key, curr->value);
+                    if (c == 0)
+                    {
+                        result[(base + i) / 64] |= std::uint64_t(1) << ((base + i) % 64);
+                        curr = nullptr;
+                    }
+                    else
+                    {
+                        curr = c < 0 ? curr->left : curr->right;
+                        if (curr != nullptr)
+                            BST_PREFETCH(curr);
+                    }
+                    if (curr == nullptr)
+                        --active;
+                    lanes[i] = curr;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Restituisce un indice immutabile con gli stessi elementi dell'albero.
+     *
+     * L'indice memorizza i valori in un unico array contiguo (layout di Eytzinger),
+     * adatto ad alberi che vengono letti molto più spesso di quanto vengano modificati.
+     * Le modifiche successive all'albero non si riflettono sull'indice.
+     *
+     * @return L'indice congelato.
+     */
+    frozen_bst<T, Comp, Equal> freeze() const
+    {
+        if (_root == nullptr)
+            return frozen_bst<T, Comp, Equal>();
+        return frozen_bst<T, Comp, Equal>(begin(), end(), _size);
+    }
+
+    /**
+     * @brief Scrive l'albero in formato binario, nel layout di `freeze()`.
+     *
+     * Disponibile solo se `T` è banalmente copiabile. Il file si riapre in sola lettura,
+     * senza ricostruire nodi, con `frozen_bst<T, Comp, Equal>::map()`; per riottenere un
+     * albero modificabile basta passare l'indice al costruttore con `bst_from_sorted`.
+     * Gli errori di scrittura sono segnalati dallo stato dello stream.
+     *
+     * @param os Lo stream binario su cui scrivere.
+     *
+     * @throw std::bad_alloc se l'allocazione dell'indice temporaneo fallisce.
+     */
+    void save(std::ostream &os) const
+    {
+        freeze().save(os);
+    }
+
+    /**
+     * @brief Restituisce un sottoalbero con radice nel nodo contenente il valore specificato.
+     *
+     * Se il valore specificato non viene trovato nel BST, viene restituito un BST vuoto.
+     * Il sottoalbero viene copiato strutturalmente, mantenendone la forma.
+     * Per leggere il sottoalbero senza copiarlo si usi `view`.
+     *
+     * @param value Il valore da cercare nel BST.
+     * @return Un BST che rappresenta il sottoalbero con radice nel nodo contenente il valore specificato.
+     * @throw Nessuna eccezione viene generata da questa funzione.
+     */
+    bst subtree(const T &value)
+    {
+        return make_subtree(value);
+    }
+
+    /**
+     * @brief Restituisce il sottoalbero con radice nel nodo equivalente a una chiave di tipo diverso da `T`.
+     *
+     * Disponibile solo se `Comp` dichiara `is_transparent` (vedi `find`).
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da cercare nel BST.
+     * @return Un BST che rappresenta il sottoalbero, vuoto se la chiave non viene trovata.
+     */
+    template <typename K, typename C = Comp, typename = typename C::is_transparent>
+    bst subtree(const K &key)
+    {
+        return make_subtree(key);
+    }
+
+    /**
+     * @brief Distrugge l'albero a partire dal nodo specificato.
+     *
+     * Distrugge i valori di tutti i nodi del sottoalbero e restituisce i nodi al pool.
+     * La visita è iterativa, quindi non esaurisce lo stack anche su alberi degeneri.
+     * Il chiamante deve staccare il sottoalbero dal resto dell'albero.
+     *
+     * @param leaf Il nodo radice dell'albero da distruggere.
+     */
+    void destroy_tree(node *leaf)
+    {
+        while (leaf != nullptr)
+        {
+            if (leaf->left != nullptr)
+                leaf = leaf->left;
+            else if (leaf->right != nullptr)
+                leaf = leaf->right;
+            else
+            {
+                node *p = leaf->parent;
+                if (p != nullptr)
+                {
+                    if (p->left == leaf)
+                        p->left = nullptr;
+                    else
+                        p->right = nullptr;
+                }
+                destroy_node(leaf);
+                leaf = p;
+            }
+        }
+    }
+
+    /**
+     * @brief Svuota l'albero.
+     *
+     * Se i valori hanno distruttore banale i nodi non vengono visitati:
+     * la memoria viene restituita in blocco liberando i blocchi del pool.
+     *
+     * @post _root == nullptr
+     * @post _size == 0
+     */
+    void clear()
+    {
+        if (!std::is_trivially_destructible<T>::value && _root != nullptr)
+        {
+            _root->parent = nullptr;
+            destroy_tree(_root);
+        }
+        else
+            _stats.deallocate(_size);
+        _pool.release();
+        _root = nullptr;
+        _size = 0;
+    }
+
+    /**
+     * @brief Stampa i valori dei nodi dell'albero in ordine.
+     *
+     * La visita è iterativa (l'albero non bilanciato può essere molto profondo) e
+     * la scrittura passa per `write_buffered`, senza svuotare os.
+     *
+     * @param root Il puntatore alla radice dell'albero.
+     * @param os Lo stream di output su cui stampare i valori dei nodi.
+     */
+    static void print(const node *root, std::ostream &os)
+    {
+        if (root != nullptr)
+            write_buffered(os, const_iterator(leftmost(root), root), const_iterator(nullptr, root),
+                           [](const T &)
+                           { return true; });
+    }
+
+    /**
+     * Funzione GOBLALE che implementa l'operatore di stream.
+     * La funzione è templata sull'albero binario di ricerca ed è messa
+     * friend per accedere ai dati privati dell'albero.
+     *
+     * @param os Lo stream di output su cui stampare i valori dei nodi.
+     * @param b L'albero binario di ricerca da stampare.
+     * @return Lo stream di output su cui sono stati stampati i valori dei nodi.
+     */
+    friend std::ostream &operator<<(std::ostream &os, const bst &b)
+    {
+        node *curr = b._root;
+
+        print(curr, os);
+
+        return os;
+    }
+
+    /**
+     * @brief Chiama f su ogni valore che soddisfa pred, usando più thread.
+     *
+     * L'albero viene diviso in pezzi (i nodi dei primi livelli e i sottoalberi sotto di essi),
+     * almeno quattro per thread; ogni thread visita un pezzo alla volta e, finito il suo,
+     * prende il prossimo ancora libero. I pezzi sono equilibrati se l'albero è bilanciato.
+     * L'ordine delle chiamate non è definito: pred e f vengono chiamati da più thread insieme.
+     *
+     * @tparam P Il tipo del predicato.
+     * @tparam F Il tipo della funzione.
+     * @param pred Il predicato da utilizzare per filtrare i valori.
+     * @param f La funzione da chiamare sui valori che soddisfano pred.
+     * @param threads Il numero massimo di thread (0 per quelli disponibili sull'hardware).
+     *
+     * @throw Eccezione generata da pred, da f o dalla creazione dei thread.
+     */
+    template <typename P, typename F>
+    void parallel_for_each_if(P pred, F f, unsigned int threads = 0) const
+    {
+        threads = thread_count(threads, _size);
+        std::vector<piece> pieces;
+        split_pieces(_root, split_depth(threads), pieces);
+        run_parallel(pieces.size(), threads, [&](std::size_t i)
+                     { visit_piece(pieces[i], [&](const T &v)
+                                   {
+                                       if (pred(v))
+                                           f(v);
+                                   }); });
+    }
+
+    /**
+     * @brief Riduce i valori dell'albero usando più thread.
+     *
+     * Calcola `op(...op(op(init, map(v1)), map(v2))..., map(vn))` con v1, ..., vn i valori in ordine.
+     * Ogni pezzo dell'albero (vedi `parallel_for_each_if`) viene ridotto da un thread e i risultati
+     * parziali vengono combinati in ordine, quindi basta che op sia associativa.
+     * map e op vengono chiamati da più thread insieme.
+     *
+     * @tparam R Il tipo del risultato.
+     * @tparam Map Il tipo della funzione che trasforma un valore in un `R`.
+     * @tparam Op Il tipo dell'operazione associativa su `R`.
+     * @param init Il valore iniziale.
+     * @param map La funzione applicata a ogni valore.
+     * @param op L'operazione che combina due risultati.
+     * @param threads Il numero massimo di thread (0 per quelli disponibili sull'hardware).
+     * @return Il risultato della riduzione, init se l'albero è vuoto.
+     *
+     * @throw Eccezione generata da map, da op o dalla creazione dei thread.
+     */
+    template <typename R, typename Map, typename Op>
+    R parallel_reduce(R init, Map map, Op op, unsigned int threads = 0) const
+    {
+        threads = thread_count(threads, _size);
+        std::vector<piece> pieces;
+        split_pieces(_root, split_depth(threads), pieces);
+        std::vector<std::optional<R>> partial(pieces.size());
+        run_parallel(pieces.size(), threads, [&](std::size_t i)
+                     { visit_piece(pieces[i], [&](const T &v)
+                                   {
+                                       if (partial[i])
+                                           partial[i] = op(std::move(*partial[i]), map(v));
+                                       else
+                                           partial[i].emplace(map(v));
+                                   }); });
+        for (std::optional<R> &r : partial)
+            init = op(std::move(init), std::move(*r));
+        return init;
+    }
+
+    /**
+     * Classe che rappresenta un iteratore costante per la classe bst.
+     * Fornisce un'interfaccia per iterare in modo costante sugli elementi di un oggetto bst,
+     * in entrambe le direzioni.
+     *
+     * `++` e `--` costano O(1) ammortizzato risalendo i genitori; con l'aumento `bst_threaded`
+     * gli iteratori sull'intero albero seguono i collegamenti in ordine e costano O(1) sempre.
+     * Un iteratore resta valido finché il suo nodo non viene rimosso; l'iteratore di fine
+     * dell'intero albero viene invalidato da `swap` e dallo spostamento dell'albero.
+     */
+    class const_iterator
+    {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const T *pointer;
+        typedef const T &reference;
+
+        /**
+         * @brief Costruttore di default.
+         */
+        const_iterator() : n(nullptr), top(nullptr), root(nullptr) {}
+
+        /**
+         * @brief Costruttore di copia.
+         *
+         * @param other L'iteratore da copiare.
+         */
+        const_iterator(const const_iterator &other) : n(other.n), top(other.top), root(other.root) {}
+
+        /**
+         * @brief Operatore di assegnazione.
+         *
+         * @param other L'iteratore da assegnare.
+         * @return Un riferimento a se stesso.
+         */
+        const_iterator &operator=(const const_iterator &other)
+        {
+            n = other.n;
+            top = other.top;
+            root = other.root;
+            return *this;
+        }
+
+        /**
+         * @brief Distruttore.
+         */
+        ~const_iterator() {}
+
+        /**
+         * @brief Operatore di dereferenziazione.
+         *
+         * @return Il riferimento costante all'elemento puntato dall'iteratore.
+         */
+        reference operator*() const
+        {
+            return n->value;
+        }
+
+        /**
+         * @brief Operatore di accesso ai membri.
+         *
+         * @return Il puntatore costante all'elemento puntato dall'iteratore.
+         */
+        pointer operator->() const
+        {
+            return &(n->value);
+        }
+
+        /**
+         * @brief Operatore di post-incremento.
+         *
+         * @return Un iteratore costante che punta all'elemento precedente.
+         */
+        const_iterator operator++(int)
+        {
+            const_iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        /**
+         * @brief Operatore di pre-incremento.
+         *
+         * @return Un riferimento a se stesso.
+         */
+        const_iterator &operator++()
+        {
+            if constexpr (threaded)
+            {
+                if (top == nullptr)
+                {
+                    n = next_of(n);
+                    return *this;
+                }
+            }
+            if (n->right == nullptr)
+            {
+                while (n != top && n->parent != nullptr && n->parent->right == n)
+                {
+                    n = n->parent;
+                }
+                n = n == top ? nullptr : n->parent;
+                return *this;
+            }
+            else
+            {
+                n = n->right;
+                while (n->left != nullptr)
+                {
+                    n = n->left;
+                }
+                return *this;
+            }
+        }
+
+        /**
+         * @brief Operatore di pre-decremento.
+         *
+         * Decrementare l'iteratore di fine porta all'ultimo elemento.
+         *
+         * @return Un riferimento a se stesso.
+         */
+        const_iterator &operator--()
+        {
+            if (n == nullptr)
+            {
+                const node *r = top != nullptr ? top : (root != nullptr ? *root : nullptr);
+                n = r == nullptr ? nullptr : rightmost(r);
+                return *this;
+            }
+            if constexpr (threaded)
+            {
+                if (top == nullptr)
+                {
+                    n = prev_of(n);
+                    return *this;
+                }
+            }
+            n = predecessor(n, top);
+            return *this;
+        }
+
+        /**
+         * @brief Operatore di post-decremento.
+         *
+         * @return Un iteratore costante che punta all'elemento precedente al decremento.
+         */
+        const_iterator operator--(int)
+        {
+            const_iterator tmp(*this);
+            --*this;
+            return tmp;
+        }
+
+        /**
+         * @brief Operatore di uguaglianza.
+         *
+         * @param other L'iteratore da confrontare.
+         * @return True se gli iteratori sono uguali, false altrimenti.
+         */
+        bool operator==(const const_iterator &other) const
+        {
+            return n == other.n;
+        }
+
+        /**
+         * @brief Operatore di disuguaglianza.
+         *
+         * @param other L'iteratore da confrontare.
+         * @return True se gli iteratori sono diversi, false altrimenti.
+         */
+        bool operator!=(const const_iterator &other) const
+        {
+            return !(other == *this);
+        }
+
+    private:
+        const node *n;
+        const node *top;          //< radice del sottoalbero visitato, nullptr per l'intero albero
+        const node *const *root;  //< radice dell'albero (per `--` dalla fine), nullptr nei sottoalberi
+
+        friend class bst;
+
+        /**
+         * @brief Costruttore privato.
+         *
+         * @param n Il puntatore al nodo dell'iteratore.
+         * @param top La radice del sottoalbero oltre cui l'iteratore non risale.
+         * @param root Il puntatore alla radice dell'albero, usato solo se top è nullptr.
+         */
+        const_iterator(const node *n, const node *top, const node *const *root = nullptr)
+            : n(n), top(top), root(root) {}
+    };
+
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+private:
+    /**
+     * @brief Crea un iteratore sull'intero albero.
+     *
+     * @param n Il nodo dell'iteratore (nullptr per la fine).
+     * @return L'iteratore, che ricorda la radice per poter decrementare la fine.
+     */
+    const_iterator make_iterator(const node *n) const
+    {
+        return const_iterator(n, nullptr, const_cast<const node *const *>(&_root));
+    }
+
+public:
+
+    /**
+     * @brief Restituisce un iteratore costante che punta all'inizio dell'albero binario di ricerca.
+     *
+     * @return Un iteratore costante che punta all'elemento minimo dell'albero binario di ricerca,
+     *         uguale a `end()` se l'albero è vuoto.
+     */
+    const_iterator begin() const
+    {
+        return make_iterator(_root == nullptr ? nullptr : leftmost(_root));
+    }
+
+    /**
+     * @brief Restituisce un iteratore costante che punta alla fine della struttura dati.
+     *
+     * @return Un iteratore costante che punta alla fine della struttura dati.
+     */
+    const_iterator end() const
+    {
+        return make_iterator(nullptr);
+    }
+
+    /**
+     * @brief Restituisce un iteratore inverso che punta all'elemento massimo.
+     *
+     * Permette di visitare l'albero in ordine decrescente senza copiarlo,
+     * ad esempio per i k valori più grandi.
+     *
+     * @return Un iteratore inverso costante.
+     */
+    const_reverse_iterator rbegin() const
+    {
+        return const_reverse_iterator(end());
+    }
+
+    /**
+     * @brief Restituisce un iteratore inverso alla fine della visita decrescente.
+     *
+     * @return Un iteratore inverso costante.
+     */
+    const_reverse_iterator rend() const
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    /**
+     * @brief Restituisce una vista pigra sui valori che soddisfano un predicato.
+     *
+     * Il predicato viene valutato durante l'iterazione, senza copiare l'albero.
+     * Con C++20 la vista si compone con `std::views`, ad esempio
+     * `b.filter(is_even) | std::views::transform(square)`.
+     *
+     * @tparam P Il tipo del predicato.
+     * @param pred Il predicato da utilizzare per filtrare gli elementi.
+     * @return La vista, valida finché l'albero non viene modificato.
+     */
+    template <typename P>
+    bst_filter_view<const_iterator, P> filter(P pred) const
+    {
+        return bst_filter_view<const_iterator, P>(begin(), end(), std::move(pred));
+    }
+
+    /**
+     * @brief Chiama f, in ordine, su ogni valore che soddisfa pred.
+     *
+     * @tparam P Il tipo del predicato.
+     * @tparam F Il tipo della funzione, invocabile con `const T &`.
+     * @param pred Il predicato da utilizzare per filtrare i valori.
+     * @param f La funzione da chiamare sui valori che soddisfano pred.
+     */
+    template <typename P, typename F>
+    void for_each_if(P pred, F f) const
+    {
+        for (const_iterator i = begin(), ie = end(); i != ie; ++i)
+            if (pred(*i))
+                f(*i);
+    }
+
+    /**
+     * @brief Scrive su uno stream i valori che soddisfano pred, seguiti dal separatore.
+     *
+     * La scrittura è bufferizzata (vedi `write_buffered`) e non svuota os.
+     *
+     * @tparam P Il tipo del predicato.
+     * @param os Lo stream di output.
+     * @param pred Il predicato da utilizzare per filtrare gli elementi.
+     * @param sep Il carattere scritto dopo ogni valore.
+     * @return Lo stream di output.
+     */
+    template <typename P>
+    std::ostream &write_if(std::ostream &os, P pred, char sep = ' ') const
+    {
+        return write_buffered(os, begin(), end(), std::move(pred), sep);
+    }
+
+    /**
+     * @brief Vista non proprietaria su un sottoalbero di un `bst`.
+     *
+     * La vista memorizza solo il nodo radice del sottoalbero: iterazione, ricerca e stampa
+     * lavorano direttamente sui nodi dell'albero, senza allocare. Resta valida finché l'albero
+     * non viene modificato (un inserimento o una rimozione possono ruotare i nodi).
+     * Per ottenere un albero indipendente si usi `clone()`.
+     */
+    class subtree_view
+    {
+    public:
+        /**
+         * @brief Costruttore di default: vista vuota.
+         */
+        subtree_view() : _tree(nullptr), _top(nullptr) {}
+
+        /**
+         * @brief Restituisce il numero di elementi del sottoalbero.
+         *
+         * Costa O(1) con l'aumento `bst_order_statistics`, altrimenti O(k).
+         *
+         * @return Il numero di elementi del sottoalbero.
+         */
+        unsigned int size() const
+        {
+            if constexpr (order_statistics)
+                return count(_top);
+            else
+                return count_nodes(const_cast<node *>(_top));
+        }
+
+        /**
+         * @brief Indica se la vista è vuota.
+         *
+         * @return True se il valore cercato non era presente nell'albero.
+         */
+        bool empty() const
+        {
+            return _top == nullptr;
+        }
+
+        /**
+         * @brief Trova un valore nel sottoalbero.
+         *
+         * @param value Il valore da cercare.
+         * @return True se il valore appartiene al sottoalbero, altrimenti false.
+         */
+        bool find(const T &value) const
+        {
+            return _top != nullptr && _tree->find_from(const_cast<node *>(_top), value) != nullptr;
+        }
+
+        /**
+         * @brief Versione di `find` per chiavi di tipo diverso da `T`.
+         *
+         * Disponibile solo se `Comp` dichiara `is_transparent`.
+         *
+         * @tparam K Il tipo della chiave.
+         * @param key La chiave da cercare.
+         * @return True se un valore equivalente alla chiave appartiene al sottoalbero.
+         */
+        template <typename K, typename C = Comp, typename = typename C::is_transparent>
+        bool find(const K &key) const
+        {
+            return _top != nullptr && _tree->find_from(const_cast<node *>(_top), key) != nullptr;
+        }
+
+        /**
+         * @brief Copia il sottoalbero in un nuovo `bst`, mantenendone la forma.
+         *
+         * @return Il nuovo albero.
+         */
+        bst clone() const
+        {
+            bst b(_tree != nullptr ? _tree->get_allocator() : Alloc());
+            if (_top != nullptr)
+                b.copy_structure(_top, size());
+            return b;
+        }
+
+        /**
+         * @brief Restituisce un iteratore al primo elemento del sottoalbero.
+         *
+         * @return Un iteratore costante che non risale oltre la radice del sottoalbero.
+         */
+        const_iterator begin() const
+        {
+            return const_iterator(_top == nullptr ? nullptr : leftmost(_top), _top);
+        }
+
+        /**
+         * @brief Restituisce un iteratore alla fine del sottoalbero.
+         *
+         * @return Un iteratore costante che punta alla fine della vista.
+         */
+        const_iterator end() const
+        {
+            return const_iterator(nullptr, _top);
+        }
+
+        /**
+         * @brief Restituisce un iteratore inverso all'elemento massimo del sottoalbero.
+         *
+         * @return Un iteratore inverso costante.
+         */
+        const_reverse_iterator rbegin() const
+        {
+            return const_reverse_iterator(end());
+        }
+
+        /**
+         * @brief Restituisce un iteratore inverso alla fine della visita decrescente del sottoalbero.
+         *
+         * @return Un iteratore inverso costante.
+         */
+        const_reverse_iterator rend() const
+        {
+            return const_reverse_iterator(begin());
+        }
+
+        /**
+         * @brief Restituisce una vista pigra sui valori del sottoalbero che soddisfano pred.
+         *
+         * @tparam P Il tipo del predicato.
+         * @param pred Il predicato da utilizzare per filtrare gli elementi.
+         * @return La vista.
+         */
+        template <typename P>
+        bst_filter_view<const_iterator, P> filter(P pred) const
+        {
+            return bst_filter_view<const_iterator, P>(begin(), end(), std::move(pred));
+        }
+
+        /**
+         * @brief Scrive su uno stream i valori del sottoalbero che soddisfano pred.
+         *
+         * @tparam P Il tipo del predicato.
+         * @param os Lo stream di output.
+         * @param pred Il predicato da utilizzare per filtrare gli elementi.
+         * @param sep Il carattere scritto dopo ogni valore.
+         * @return Lo stream di output.
+         */
+        template <typename P>
+        std::ostream &write_if(std::ostream &os, P pred, char sep = ' ') const
+        {
+            return write_buffered(os, begin(), end(), std::move(pred), sep);
+        }
+
+        /**
+         * Funzione GLOBALE che implementa l'operatore di stream.
+         *
+         * @param os Lo stream di output su cui stampare i valori.
+         * @param v La vista da stampare.
+         * @return Lo stream di output su cui sono stati stampati i valori.
+         */
+        friend std::ostream &operator<<(std::ostream &os, const subtree_view &v)
+        {
+            print(v._top, os);
+            return os;
+        }
+
+        /**
+         * Funzione GLOBALE che stampa a schermo i soli valori
+         * del sottoalbero che soddisfano un predicato specificato dall'utente.
+         *
+         * @tparam P Il tipo del predicato da utilizzare per filtrare gli elementi.
+         * @param v La vista da stampare.
+         * @param pred Il predicato da utilizzare per filtrare gli elementi.
+         */
+        template <typename P>
+        friend void printIF(const subtree_view &v, P pred)
+        {
+            v.write_if(std::cout, pred, '\n');
+            std::cout.flush();
+        }
+
+    private:
+        const bst *_tree; //< albero a cui appartiene il sottoalbero
+        const node *_top; //< radice del sottoalbero
+
+        friend class bst;
+
+        /**
+         * @brief Costruttore privato.
+         *
+         * @param tree L'albero a cui appartiene il sottoalbero.
+         * @param top La radice del sottoalbero (nullptr per una vista vuota).
+         */
+        subtree_view(const bst *tree, const node *top) : _tree(tree), _top(top) {}
+    };
+
+    /**
+     * @brief Restituisce una vista sul sottoalbero con radice nel nodo contenente value.
+     *
+     * A differenza di `subtree` non copia nulla: costa una sola discesa dalla radice.
+     *
+     * @param value Il valore da cercare.
+     * @return La vista sul sottoalbero, vuota se value non viene trovato.
+     */
+    subtree_view view(const T &value) const
+    {
+        return subtree_view(this, find_node(value));
+    }
+
+    /**
+     * @brief Versione di `view` per chiavi di tipo diverso da `T`.
+     *
+     * Disponibile solo se `Comp` dichiara `is_transparent` (vedi `find`).
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da cercare.
+     * @return La vista sul sottoalbero, vuota se la chiave non viene trovata.
+     */
+    template <typename K, typename C = Comp, typename = typename C::is_transparent>
+    subtree_view view(const K &key) const
+    {
+        return subtree_view(this, find_node(key));
+    }
+
+    /**
+     * @brief Restituisce il numero di elementi minori di value.
+     *
+     * Richiede l'aumento `bst_order_statistics`; costa O(h).
+     *
+     * @param value Il valore da confrontare.
+     * @return La posizione (a partire da 0) che value occupa, o occuperebbe, nell'ordine.
+     */
+    unsigned int rank(const T &value) const
+    {
+        return rank_key(value);
+    }
+
+    /**
+     * @brief Versione di `rank` per chiavi di tipo diverso da `T`.
+     *
+     * Disponibile solo se `Comp` dichiara `is_transparent` (vedi `find`).
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da confrontare.
+     * @return Il numero di elementi minori della chiave.
+     */
+    template <typename K, typename C = Comp, typename = typename C::is_transparent>
+    unsigned int rank(const K &key) const
+    {
+        return rank_key(key);
+    }
+
+    /**
+     * @brief Restituisce un iteratore al k-esimo elemento più piccolo (a partire da 0).
+     *
+     * Richiede l'aumento `bst_order_statistics`; costa O(h).
+     * Ad esempio `select(size() / 2)` è la mediana.
+     *
+     * @param k La posizione dell'elemento nell'ordine.
+     * @return L'iteratore all'elemento, oppure end() se k >= size().
+     */
+    const_iterator select(unsigned int k) const
+    {
+        static_assert(order_statistics, "select richiede l'aumento bst_order_statistics");
+        const node *curr = _root;
+        while (curr != nullptr)
+        {
+            unsigned int left = count(curr->left);
+            if (k < left)
+                curr = curr->left;
+            else if (k == left)
+                break;
+            else
+            {
+                k -= left + 1;
+                curr = curr->right;
+            }
+        }
+        return make_iterator(curr);
+    }
+
+    /**
+     * @brief Conta gli elementi nell'intervallo [lo, hi).
+     *
+     * Richiede l'aumento `bst_order_statistics`; costa O(h).
+     *
+     * @param lo L'estremo inferiore, incluso.
+     * @param hi L'estremo superiore, escluso.
+     * @return Il numero di elementi non minori di lo e minori di hi.
+     */
+    unsigned int count_range(const T &lo, const T &hi) const
+    {
+        unsigned int l = rank_key(lo);
+        unsigned int h = rank_key(hi);
+        return h > l ? h - l : 0;
+    }
+
+    /**
+     * @brief Rimuove l'elemento puntato da un iteratore.
+     *
+     * @param pos Un iteratore valido e dereferenziabile di questo albero.
+     * @return Un iteratore all'elemento successivo a quello rimosso.
+     */
+    const_iterator erase(const_iterator pos)
+    {
+        node *n = const_cast<node *>(pos.n);
+        node *next = successor(n, nullptr);
+        erase_node(n);
+        return make_iterator(next);
+    }
+
+    /**
+     * @brief Restituisce un iteratore al primo elemento non minore di value.
+     *
+     * Permette di iniziare una scansione per intervallo direttamente dal primo elemento utile.
+     *
+     * @param value Il valore da confrontare.
+     * @return L'iteratore trovato, oppure end().
+     */
+    const_iterator lower_bound(const T &value) const
+    {
+        return make_iterator(lower_node(value));
+    }
+
+    /**
+     * @brief Restituisce un iteratore al primo elemento maggiore di value.
+     *
+     * @param value Il valore da confrontare.
+     * @return L'iteratore trovato, oppure end().
+     */
+    const_iterator upper_bound(const T &value) const
+    {
+        return make_iterator(upper_node(value));
+    }
+
+    /**
+     * @brief Restituisce l'intervallo degli elementi equivalenti a value.
+     *
+     * @param value Il valore da cercare.
+     * @return La coppia (lower_bound(value), upper_bound(value)): vuota se value non è presente,
+     *         altrimenti contiene il solo elemento trovato.
+     */
+    std::pair<const_iterator, const_iterator> equal_range(const T &value) const
+    {
+        return std::make_pair(lower_bound(value), upper_bound(value));
+    }
+
+    /**
+     * @brief Versione di `lower_bound` per chiavi di tipo diverso da `T`.
+     *
+     * Disponibile solo se `Comp` dichiara `is_transparent` (vedi `find`).
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da confrontare.
+     * @return L'iteratore al primo elemento non minore della chiave, oppure end().
+     */
+    template <typename K, typename C = Comp, typename = typename C::is_transparent>
+    const_iterator lower_bound(const K &key) const
+    {
+        return make_iterator(lower_node(key));
+    }
+
+    /**
+     * @brief Versione di `upper_bound` per chiavi di tipo diverso da `T`.
+     *
+     * Disponibile solo se `Comp` dichiara `is_transparent` (vedi `find`).
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da confrontare.
+     * @return L'iteratore al primo elemento maggiore della chiave, oppure end().
+     */
+    template <typename K, typename C = Comp, typename = typename C::is_transparent>
+    const_iterator upper_bound(const K &key) const
+    {
+        return make_iterator(upper_node(key));
+    }
+
+    /**
+     * @brief Versione di `equal_range` per chiavi di tipo diverso da `T`.
+     *
+     * Disponibile solo se `Comp` dichiara `is_transparent` (vedi `find`).
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da cercare.
+     * @return La coppia (lower_bound(key), upper_bound(key)).
+     */
+    template <typename K, typename C = Comp, typename = typename C::is_transparent>
+    std::pair<const_iterator, const_iterator> equal_range(const K &key) const
+    {
+        return std::make_pair(lower_bound(key), upper_bound(key));
+    }
+};
+
+/**
+ * Funzione GLOBALE che stampa a schermo i soli valori
+ * dei nodi di un albero binario di ricerca
+ * che soddisfano un predicato specificato dall'utente.
+ *
+ * @tparam T Il tipo degli elementi nell'albero binario di ricerca.
+ * @tparam Comp Il funtore di confronto per ordinare gli elementi nell'albero.
+ * @tparam Equal Il funtore di confronto per verificare l'uguaglianza tra gli elementi.
+ * @tparam Balance La policy di bilanciamento dell'albero.
+ * @tparam Augment Le informazioni aggiuntive nei nodi dell'albero.
+ * @tparam Stats La policy di strumentazione dell'albero.
+ * @tparam Alloc L'allocatore dell'albero.
+ * @tparam P Il tipo del predicato da utilizzare per filtrare gli elementi.
+ *
+ * L'output è bufferizzato e `std::cout` viene svuotato una sola volta, alla fine:
+ * per scrivere su un altro stream si usi `bst::write_if`.
+ *
+ * @param b L'albero binario di ricerca da stampare.
+ * @param pred Il predicato da utilizzare per filtrare gli elementi.
+ */
+template <typename T, typename Comp, typename Equal, typename Balance, typename Augment, typename Stats, typename Alloc,
+          typename P>
+void printIF(const bst<T, Comp, Equal, Balance, Augment, Stats, Alloc> &b, P pred)
+{
+    b.write_if(std::cout, pred, '\n');
+    std::cout.flush();
+}
+
+#ifdef __cpp_lib_memory_resource
+/**
+ * @brief `bst` che alloca i nodi da una `std::pmr::memory_resource`.
+ *
+ * Esempio: con una `std::pmr::monotonic_buffer_resource` l'albero viene costruito e distrutto
+ * interamente nel buffer, senza passare dall'heap globale:
+ * `pmr_bst<int, compare_int, equal_int> b(&resource);`
+ */
+template <typename T, typename Comp, typename Equal = bst_equivalent<Comp>, typename Balance = bst_unbalanced,
+          typename Augment = bst_no_augment, typename Stats = bst_no_stats>
+using pmr_bst = bst<T, Comp, Equal, Balance, Augment, Stats, std::pmr::polymorphic_allocator<T>>;
+#endif
+
 #endif
\ No newline at end of file
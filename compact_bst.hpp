@@ -0,0 +1,738 @@
+#ifndef COMPACT_BST_HPP
+#define COMPACT_BST_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "bst.hpp"
+
+/**
+ * @brief Albero binario di ricerca compatto, per valori piccoli e alberi molto grandi.
+ *
+ * I nodi stanno tutti in un unico `std::vector`, senza un'allocazione per nodo, e i figli
+ * sono indici a 32 bit invece di puntatori; manca il puntatore al genitore. Per `int`
+ * un nodo occupa 12 byte (16 con la policy `bst_avl`), contro i circa 48 di `bst`.
+ *
+ * Senza genitori gli inserimenti e le rimozioni ricordano il cammino dalla radice e
+ * l'iteratore tiene la pila degli antenati. Dopo una rimozione l'ultimo nodo del vettore
+ * viene spostato nel posto lasciato libero, così il vettore resta sempre denso.
+ * Qualunque modifica invalida gli iteratori.
+ *
+ * L'albero contiene al più 2^32 - 2 valori.
+ *
+ * @tparam T Il tipo di valore contenuto nei nodi dell'albero.
+ * @tparam Comp Il tipo di funzione di confronto per ordinare i nodi.
+ * @tparam Equal Il tipo di funzione di uguaglianza per confrontare i valori dei nodi
+ *               (di default ricavata da `Comp`, vedi `bst_equivalent`).
+ * @tparam Balance La policy di bilanciamento (`bst_unbalanced` o `bst_avl`).
+ */
+template <typename T, typename Comp, typename Equal = bst_equivalent<Comp>, typename Balance = bst_unbalanced>
+class compact_bst
+{
+public:
+    typedef std::uint32_t index_type;
+
+    static constexpr index_type npos = 0xFFFFFFFFu; //< indice nullo
+
+private:
+    /**
+     * @brief Struttura che rappresenta un nodo dell'albero.
+     *
+     * Con la policy `bst_avl` eredita l'altezza da `Balance::node_meta`.
+     */
+    struct node : public Balance::node_meta
+    {
+        T value;          //< valore del nodo
+        index_type left;  //< indice del figlio sinistro, npos se assente
+        index_type right; //< indice del figlio destro, npos se assente
+
+        template <typename V>
+        explicit node(V &&v) : value(std::forward<V>(v)), left(npos), right(npos) {}
+    };
+
+    static constexpr bool avl = std::is_same<Balance, bst_avl>::value;
+    static constexpr bool derived_equal = bst_derived_equal<Comp, Equal>::value;
+
+    static constexpr std::size_t max_depth = 64; //< profondità massima di un albero AVL con 2^32 nodi, con margine
+
+    std::vector<node> _nodes; //< nodi dell'albero, senza buchi
+    index_type _root;         //< indice della radice, npos se l'albero è vuoto
+    Comp _compare;            //< funtore per il confronto tra i valori dei nodi
+    Equal _equal;             //< funtore per l'uguaglianza tra i valori dei nodi
+
+    /**
+     * @brief Restituisce l'altezza del sottoalbero con radice i (0 se vuoto).
+     */
+    int height(index_type i) const
+    {
+        if constexpr (avl)
+            return i == npos ? 0 : _nodes[i].height;
+        else
+            return 0;
+    }
+
+    /**
+     * @brief Ricalcola l'altezza del nodo i a partire dai figli.
+     */
+    void update(index_type i)
+    {
+        if constexpr (avl)
+            _nodes[i].height = static_cast<unsigned char>(1 + std::max(height(_nodes[i].left), height(_nodes[i].right)));
+    }
+
+    /**
+     * @brief Ruota a sinistra il sottoalbero con radice x.
+     *
+     * @return La nuova radice del sottoalbero.
+     */
+    index_type rotate_left(index_type x)
+    {
+        index_type y = _nodes[x].right;
+        _nodes[x].right = _nodes[y].left;
+        _nodes[y].left = x;
+        update(x);
+        update(y);
+        return y;
+    }
+
+    /**
+     * @brief Ruota a destra il sottoalbero con radice x.
+     *
+     * @return La nuova radice del sottoalbero.
+     */
+    index_type rotate_right(index_type x)
+    {
+        index_type y = _nodes[x].left;
+        _nodes[x].left = _nodes[y].right;
+        _nodes[y].right = x;
+        update(x);
+        update(y);
+        return y;
+    }
+
+    /**
+     * @brief Ripristina la regola AVL nel nodo i, i cui figli sono già bilanciati.
+     *
+     * @return La nuova radice del sottoalbero.
+     */
+    index_type balance(index_type i)
+    {
+        update(i);
+        int bf = height(_nodes[i].left) - height(_nodes[i].right);
+        if (bf > 1)
+        {
+            index_type l = _nodes[i].left;
+            if (height(_nodes[l].left) < height(_nodes[l].right))
+                _nodes[i].left = rotate_left(l);
+            return rotate_right(i);
+        }
+        if (bf < -1)
+        {
+            index_type r = _nodes[i].right;
+            if (height(_nodes[r].right) < height(_nodes[r].left))
+                _nodes[i].right = rotate_right(r);
+            return rotate_left(i);
+        }
+        return i;
+    }
+
+    /**
+     * @brief Ribilancia i nodi del cammino path[0..depth), dal basso verso la radice.
+     *
+     * @param path Gli indici dei nodi dalla radice in giù.
+     * @param depth Il numero di nodi del cammino.
+     */
+    void rebalance(const index_type *path, std::size_t depth)
+    {
+        if constexpr (avl)
+        {
+            for (std::size_t k = depth; k-- > 0;)
+            {
+                index_type i = path[k];
+                index_type b = balance(i);
+                if (b == i)
+                    continue;
+                if (k == 0)
+                    _root = b;
+                else if (_nodes[path[k - 1]].left == i)
+                    _nodes[path[k - 1]].left = b;
+                else
+                    _nodes[path[k - 1]].right = b;
+            }
+        }
+    }
+
+    /**
+     * @brief Restituisce il collegamento (radice o figlio) che punta al nodo i.
+     *
+     * Il nodo viene cercato scendendo dalla radice con il suo stesso valore.
+     */
+    index_type &link_to(index_type i)
+    {
+        index_type *link = &_root;
+        while (*link != i)
+        {
+            const node &n = _nodes[*link];
+            link = _compare(_nodes[i].value, n.value) ? &_nodes[*link].left : &_nodes[*link].right;
+        }
+        return *link;
+    }
+
+    /**
+     * @brief Cerca il nodo equivalente alla chiave.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da cercare.
+     * @return L'indice del nodo, oppure npos.
+     */
+    template <typename K>
+    index_type find_index(const K &key) const
+    {
+        index_type curr = _root;
+        if constexpr (derived_equal)
+        {
+            // un solo confronto per livello, come in bst: si controlla solo l'ultimo nodo non maggiore
+            index_type candidate = npos;
+            while (curr != npos)
+            {
+                const node &n = _nodes[curr];
+                if (_compare(key, n.value))
+                    curr = n.left;
+                else
+                {
+                    candidate = curr;
+                    curr = n.right;
+                }
+            }
+            if (candidate != npos && _compare(_nodes[candidate].value, key))
+                candidate = npos;
+            return candidate;
+        }
+        else
+        {
+            while (curr != npos)
+            {
+                const node &n = _nodes[curr];
+                if (_equal(key, n.value))
+                    return curr;
+                curr = _compare(key, n.value) ? n.left : n.right;
+            }
+            return npos;
+        }
+    }
+
+    /**
+     * @brief Inserisce un valore, se non è già presente.
+     *
+     * @param value Il valore da inserire, copiato o spostato nel nuovo nodo.
+     * @return True se il valore è stato aggiunto.
+     *
+     * @throw std::length_error se l'albero ha già il numero massimo di nodi, oppure
+     *        eccezione generata dall'allocazione o dalla copia del valore; in tal caso
+     *        l'albero resta invariato.
+     */
+    template <typename V>
+    bool insert_value(V &&value)
+    {
+        // il cammino serve solo per ribilanciare: un albero AVL resta entro max_depth
+        index_type path[avl ? max_depth : 1];
+        std::size_t depth = 0;
+        index_type parent = npos;
+        index_type curr = _root;
+        bool left = false;
+        index_type candidate = npos; // usato solo con derived_equal
+        while (curr != npos)
+        {
+            const node &n = _nodes[curr];
+            if constexpr (!derived_equal)
+            {
+                if (_equal(value, n.value))
+                    return false;
+            }
+            if constexpr (avl)
+                path[depth++] = curr;
+            parent = curr;
+            left = _compare(value, n.value);
+            if (!left)
+                candidate = curr;
+            curr = left ? n.left : n.right;
+        }
+        if constexpr (derived_equal)
+        {
+            if (candidate != npos && !_compare(_nodes[candidate].value, value))
+                return false;
+        }
+        if (_nodes.size() >= npos - 1)
+            throw std::length_error("compact_bst: troppi elementi");
+
+        index_type i = static_cast<index_type>(_nodes.size());
+        _nodes.emplace_back(std::forward<V>(value));
+        if (parent == npos)
+            _root = i;
+        else if (left)
+            _nodes[parent].left = i;
+        else
+            _nodes[parent].right = i;
+        rebalance(path, depth);
+        return true;
+    }
+
+    /**
+     * @brief Rimuove il valore equivalente alla chiave.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da rimuovere.
+     * @return 1 se un valore è stato rimosso, altrimenti 0.
+     */
+    template <typename K>
+    unsigned int erase_key(const K &key)
+    {
+        index_type path[avl ? max_depth : 1];
+        std::size_t depth = 0;
+        index_type *link = &_root;
+        if constexpr (derived_equal)
+        {
+            // si scende fino in fondo e si torna al collegamento dell'ultimo candidato:
+            // il cammino fino al candidato resta quello giusto
+            index_type *candidate = nullptr;
+            std::size_t candidate_depth = 0;
+            while (*link != npos)
+            {
+                node &n = _nodes[*link];
+                bool left = _compare(key, n.value);
+                if (!left)
+                {
+                    candidate = link;
+                    candidate_depth = depth;
+                }
+                if constexpr (avl)
+                    path[depth++] = *link;
+                link = left ? &n.left : &n.right;
+            }
+            if (candidate == nullptr || _compare(_nodes[*candidate].value, key))
+                return 0;
+            link = candidate;
+            depth = candidate_depth;
+        }
+        else
+        {
+            while (*link != npos && !_equal(key, _nodes[*link].value))
+            {
+                if constexpr (avl)
+                    path[depth++] = *link;
+                node &n = _nodes[*link];
+                link = _compare(key, n.value) ? &n.left : &n.right;
+            }
+        }
+        index_type z = *link;
+        if (z == npos)
+            return 0;
+
+        // il nodo da staccare: z stesso, o il suo successore se z ha due figli
+        index_type target = z;
+        if (_nodes[z].left != npos && _nodes[z].right != npos)
+        {
+            if constexpr (avl)
+                path[depth++] = z;
+            link = &_nodes[z].right;
+            while (_nodes[*link].left != npos)
+            {
+                if constexpr (avl)
+                    path[depth++] = *link;
+                link = &_nodes[*link].left;
+            }
+            target = *link;
+            _nodes[z].value = std::move(_nodes[target].value);
+        }
+        *link = _nodes[target].left != npos ? _nodes[target].left : _nodes[target].right;
+        rebalance(path, depth);
+
+        // riempie il buco con l'ultimo nodo del vettore
+        index_type last = static_cast<index_type>(_nodes.size() - 1);
+        if (target != last)
+        {
+            index_type &link = link_to(last);
+            _nodes[target] = std::move(_nodes[last]);
+            link = target;
+        }
+        _nodes.pop_back();
+        return 1;
+    }
+
+    /**
+     * @brief Collega in un albero perfettamente bilanciato i nodi [lo, hi), già in ordine.
+     *
+     * @return L'indice della radice del sottoalbero.
+     */
+    index_type link_range(index_type lo, index_type hi)
+    {
+        if (lo == hi)
+            return npos;
+        index_type mid = lo + (hi - lo) / 2;
+        _nodes[mid].left = link_range(lo, mid);
+        _nodes[mid].right = link_range(mid + 1, hi);
+        update(mid);
+        return mid;
+    }
+
+public:
+    /**
+     * @brief Costruttore di default: albero vuoto.
+     */
+    compact_bst() : _root(npos) {}
+
+    /**
+     * @brief Costruisce un albero a partire da una sequenza di elementi.
+     *
+     * @tparam Iter Il tipo dell'iteratore.
+     * @param begin L'iteratore di inizio della sequenza.
+     * @param end L'iteratore di fine della sequenza.
+     *
+     * @throw Eccezione generata durante l'inserimento degli elementi.
+     */
+    template <typename Iter>
+    compact_bst(Iter begin, Iter end) : _root(npos)
+    {
+        for (; begin != end; ++begin)
+            add(*begin);
+    }
+
+    /**
+     * @brief Costruisce un albero bilanciato da una sequenza già ordinata, in O(n).
+     *
+     * I nodi vengono disposti nel vettore nello stesso ordine dei valori, così
+     * la visita in ordine scorre la memoria in modo sequenziale.
+     *
+     * @tparam Iter Il tipo dell'iteratore.
+     * @param begin L'iteratore di inizio della sequenza.
+     * @param end L'iteratore di fine della sequenza.
+     *
+     * @pre La sequenza è ordinata in modo strettamente crescente secondo `Comp`.
+     *
+     * @throw std::length_error se la sequenza ha troppi elementi, oppure
+     *        eccezione generata dall'allocazione o dalla copia dei valori.
+     */
+    template <typename Iter>
+    compact_bst(bst_from_sorted_t, Iter begin, Iter end) : _root(npos)
+    {
+        typedef typename std::iterator_traits<Iter>::iterator_category category;
+        if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value)
+            _nodes.reserve(static_cast<std::size_t>(std::distance(begin, end)));
+        for (; begin != end; ++begin)
+        {
+            assert(_nodes.empty() || _compare(_nodes.back().value, *begin));
+            if (_nodes.size() >= npos - 1)
+                throw std::length_error("compact_bst: troppi elementi");
+            _nodes.emplace_back(*begin);
+        }
+        _root = link_range(0, static_cast<index_type>(_nodes.size()));
+    }
+
+    /**
+     * @brief Aggiunge un valore all'albero.
+     *
+     * Se il valore è già presente l'albero resta invariato.
+     *
+     * @param value Il valore da aggiungere all'albero.
+     *
+     * @throw std::length_error se l'albero è pieno, oppure eccezione generata
+     *        dall'allocazione o dalla copia del valore.
+     */
+    void add(const T &value)
+    {
+        insert_value(value);
+    }
+
+    /**
+     * @brief Aggiunge un valore all'albero spostandolo nel nuovo nodo.
+     *
+     * @param value Il valore da aggiungere all'albero.
+     *
+     * @throw std::length_error se l'albero è pieno, oppure eccezione generata
+     *        dall'allocazione o dallo spostamento del valore.
+     */
+    void add(T &&value)
+    {
+        insert_value(std::move(value));
+    }
+
+    /**
+     * @brief Rimuove un valore dall'albero.
+     *
+     * @param value Il valore da rimuovere.
+     * @return Il numero di valori rimossi (0 o 1).
+     */
+    unsigned int erase(const T &value)
+    {
+        return erase_key(value);
+    }
+
+    /**
+     * @brief Rimuove il valore equivalente alla chiave.
+     *
+     * Disponibile solo se `Comp` dichiara `is_transparent`.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da rimuovere.
+     * @return Il numero di valori rimossi (0 o 1).
+     */
+    template <typename K, typename C = Comp, typename = typename C::is_transparent>
+    unsigned int erase(const K &key)
+    {
+        return erase_key(key);
+    }
+
+    /**
+     * @brief Trova un valore nell'albero.
+     *
+     * @param value Il valore da cercare nell'albero.
+     * @return True se il valore viene trovato, altrimenti false.
+     */
+    bool find(const T &value) const
+    {
+        return find_index(value) != npos;
+    }
+
+    /**
+     * @brief Trova un valore a partire da una chiave di tipo diverso da `T`.
+     *
+     * Disponibile solo se `Comp` dichiara `is_transparent`.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da cercare.
+     * @return True se un valore equivalente alla chiave viene trovato, altrimenti false.
+     */
+    template <typename K, typename C = Comp, typename = typename C::is_transparent>
+    bool find(const K &key) const
+    {
+        return find_index(key) != npos;
+    }
+
+    /**
+     * @brief Restituisce la dimensione dell'albero.
+     *
+     * @return La dimensione dell'albero.
+     */
+    unsigned int size() const
+    {
+        return static_cast<unsigned int>(_nodes.size());
+    }
+
+    /**
+     * @brief Svuota l'albero, mantenendo la memoria già riservata.
+     */
+    void clear()
+    {
+        _nodes.clear();
+        _root = npos;
+    }
+
+    /**
+     * @brief Riserva lo spazio per n nodi, evitando le riallocazioni durante gli inserimenti.
+     *
+     * @param n Il numero di nodi.
+     */
+    void reserve(std::size_t n)
+    {
+        _nodes.reserve(n);
+    }
+
+    /**
+     * @brief Restituisce al sistema la memoria riservata e non usata.
+     */
+    void shrink_to_fit()
+    {
+        _nodes.shrink_to_fit();
+    }
+
+    /**
+     * @brief Restituisce la memoria occupata dai nodi, compresa quella riservata.
+     *
+     * @return Il numero di byte.
+     */
+    std::size_t memory() const
+    {
+        return _nodes.capacity() * sizeof(node);
+    }
+
+    /**
+     * Funzione GLOBALE che implementa l'operatore di stream.
+     *
+     * @param os Lo stream di output su cui stampare i valori dei nodi.
+     * @param b L'albero da stampare.
+     * @return Lo stream di output su cui sono stati stampati i valori dei nodi.
+     */
+    friend std::ostream &operator<<(std::ostream &os, const compact_bst &b)
+    {
+        return write_buffered(os, b.begin(), b.end(), [](const T &)
+                              { return true; });
+    }
+
+    /**
+     * Classe che rappresenta un iteratore costante (in ordine) per la classe compact_bst.
+     *
+     * I nodi non hanno il puntatore al genitore, quindi l'iteratore tiene la pila degli
+     * indici degli antenati ancora da visitare. Resta valido finché l'albero non viene modificato.
+     */
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const T *pointer;
+        typedef const T &reference;
+
+        /**
+         * @brief Costruttore di default.
+         */
+        const_iterator() : nodes(nullptr) {}
+
+        /**
+         * @brief Operatore di dereferenziazione.
+         *
+         * @return Il riferimento costante all'elemento puntato dall'iteratore.
+         */
+        reference operator*() const
+        {
+            return nodes[stack.back()].value;
+        }
+
+        /**
+         * @brief Operatore di accesso ai membri.
+         *
+         * @return Il puntatore costante all'elemento puntato dall'iteratore.
+         */
+        pointer operator->() const
+        {
+            return &nodes[stack.back()].value;
+        }
+
+        /**
+         * @brief Operatore di post-incremento.
+         *
+         * @return Un iteratore costante che punta all'elemento precedente.
+         */
+        const_iterator operator++(int)
+        {
+            const_iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        /**
+         * @brief Operatore di pre-incremento.
+         *
+         * @return Un riferimento a se stesso.
+         */
+        const_iterator &operator++()
+        {
+            index_type i = stack.back();
+            stack.pop_back();
+            push_left(nodes[i].right);
+            return *this;
+        }
+
+        /**
+         * @brief Operatore di uguaglianza.
+         *
+         * @param other L'iteratore da confrontare.
+         * @return True se gli iteratori sono uguali, false altrimenti.
+         */
+        bool operator==(const const_iterator &other) const
+        {
+            if (stack.empty() || other.stack.empty())
+                return stack.empty() == other.stack.empty();
+            return stack.back() == other.stack.back();
+        }
+
+        /**
+         * @brief Operatore di disuguaglianza.
+         *
+         * @param other L'iteratore da confrontare.
+         * @return True se gli iteratori sono diversi, false altrimenti.
+         */
+        bool operator!=(const const_iterator &other) const
+        {
+            return !(other == *this);
+        }
+
+    private:
+        const node *nodes;             //< nodi dell'albero
+        std::vector<index_type> stack; //< antenati non ancora visitati, in cima il nodo corrente
+
+        friend class compact_bst;
+
+        /**
+         * @brief Costruttore privato: iteratore sul minimo del sottoalbero con radice i.
+         *
+         * @param nodes I nodi dell'albero.
+         * @param i La radice (npos per la fine).
+         */
+        const_iterator(const node *nodes, index_type i) : nodes(nodes)
+        {
+            push_left(i);
+        }
+
+        /**
+         * @brief Scende lungo i figli sinistri a partire da i, impilando i nodi attraversati.
+         *
+         * @param i L'indice di partenza (anche npos).
+         */
+        void push_left(index_type i)
+        {
+            for (; i != npos; i = nodes[i].left)
+                stack.push_back(i);
+        }
+    };
+
+    /**
+     * @brief Restituisce un iteratore costante che punta all'elemento minimo dell'albero.
+     *
+     * @return Un iteratore costante che punta all'inizio dell'albero.
+     */
+    const_iterator begin() const
+    {
+        return const_iterator(_nodes.data(), _root);
+    }
+
+    /**
+     * @brief Restituisce un iteratore costante che punta alla fine dell'albero.
+     *
+     * @return Un iteratore costante che punta alla fine dell'albero.
+     */
+    const_iterator end() const
+    {
+        return const_iterator(_nodes.data(), npos);
+    }
+};
+
+/**
+ * Funzione GLOBALE che stampa a schermo i soli valori
+ * di un albero compatto che soddisfano un predicato specificato dall'utente.
+ *
+ * @tparam T Il tipo degli elementi nell'albero.
+ * @tparam Comp Il funtore di confronto per ordinare gli elementi nell'albero.
+ * @tparam Equal Il funtore di confronto per verificare l'uguaglianza tra gli elementi.
+ * @tparam Balance La policy di bilanciamento dell'albero.
+ * @tparam P Il tipo del predicato da utilizzare per filtrare gli elementi.
+ *
+ * @param b L'albero da stampare.
+ * @param pred Il predicato da utilizzare per filtrare gli elementi.
+ */
+template <typename T, typename Comp, typename Equal, typename Balance, typename P>
+void printIF(const compact_bst<T, Comp, Equal, Balance> &b, P pred)
+{
+    write_buffered(std::cout, b.begin(), b.end(), pred, '\n');
+    std::cout.flush();
+}
+
+#endif
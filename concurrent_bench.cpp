@@ -0,0 +1,193 @@
+/**
+ * @file concurrent_bench.cpp
+ *
+ * @brief Test di stress e benchmark multi-thread di concurrent_bst
+ *
+ * Confronta concurrent_bst con un bst protetto da un unico mutex globale,
+ * su un carico misto (90% ricerche, 5% inserimenti, 5% rimozioni),
+ * al crescere del numero di thread.
+ */
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+
+#include "bst.hpp"
+#include "concurrent_bst.hpp"
+
+/**
+ * @brief Funtore di ordinamento tra tipi interi
+ */
+struct compare_int
+{
+    bool operator()(int a, int b) const
+    {
+        return a < b;
+    }
+};
+
+// uguaglianza ricavata da compare_int: un solo confronto per livello in entrambi gli alberi
+typedef concurrent_bst<int, compare_int> cbst_int;
+typedef bst<int, compare_int> bst_int;
+
+const int key_range = 1 << 20;       // chiavi estratte in [0, key_range)
+const int ops_per_thread = 1000000;  // operazioni eseguite da ogni thread
+
+std::atomic<unsigned long> hits(0);  // ricerche riuscite, stampate alla fine perché le ricerche non vengano eliminate
+
+/**
+ * @brief bst protetto da un mutex globale, come termine di paragone.
+ */
+struct locked_bst
+{
+    bst_int tree;
+    std::mutex m;
+
+    bool find(int v)
+    {
+        std::lock_guard<std::mutex> lock(m);
+        return tree.find(v);
+    }
+
+    void add(int v)
+    {
+        std::lock_guard<std::mutex> lock(m);
+        tree.add(v);
+    }
+
+    void erase(int v)
+    {
+        std::lock_guard<std::mutex> lock(m);
+        tree.erase(v);
+    }
+};
+
+/**
+ * @brief Esegue il carico misto con nthreads thread e restituisce i milioni di operazioni al secondo.
+ */
+template <typename Tree>
+double run(Tree &tree, unsigned nthreads)
+{
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < nthreads; ++t)
+    {
+        threads.emplace_back([&tree, t]()
+                             {
+                                 std::mt19937 gen(t + 1);
+                                 std::uniform_int_distribution<int> key(0, key_range - 1);
+                                 std::uniform_int_distribution<int> op(0, 99);
+                                 unsigned long found = 0;
+                                 for (int i = 0; i < ops_per_thread; ++i)
+                                 {
+                                     int k = key(gen);
+                                     int o = op(gen);
+                                     if (o < 90)
+                                         found += tree.find(k);
+                                     else if (o < 95)
+                                         tree.add(k);
+                                     else
+                                         tree.erase(k);
+                                 }
+                                 hits.fetch_add(found, std::memory_order_relaxed);
+                             });
+    }
+    for (std::thread &th : threads)
+        th.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return nthreads * double(ops_per_thread) / elapsed.count() / 1e6;
+}
+
+/**
+ * @brief Inserisce e rimuove chiavi disgiunte da più thread e verifica lo stato finale.
+ *
+ * Mentre gli scrittori lavorano, un lettore controlla che le chiavi negative,
+ * inserite prima di partire e mai rimosse, vengano sempre trovate, anche
+ * visitando l'albero con for_each.
+ */
+bool stress(unsigned nthreads)
+{
+    cbst_int tree;
+    const int per_thread = 100000;
+    const int stable = 1000;
+    // chiavi inserite in ordine: l'albero si ribilancia con le rotazioni
+    for (int i = 0; i < stable; ++i)
+        tree.add(-1 - i);
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < nthreads; ++t)
+    {
+        threads.emplace_back([&tree, t, nthreads]()
+                             {
+                                 std::vector<int> mine(per_thread);
+                                 for (int i = 0; i < per_thread; ++i)
+                                     mine[i] = i;
+                                 std::shuffle(mine.begin(), mine.end(), std::mt19937(t + 1));
+                                 for (int i : mine)
+                                     tree.add(i * int(nthreads) + int(t));
+                                 for (int i : mine)
+                                     if (i % 2 == 0)
+                                         tree.erase(i * int(nthreads) + int(t));
+                             });
+    }
+    bool readers_ok = true;
+    std::thread reader([&tree, &readers_ok]()
+                       {
+                           for (int round = 0; round < 50; ++round)
+                           {
+                               for (int i = 1; i <= stable; ++i)
+                                   readers_ok = readers_ok && tree.find(-i);
+                               int seen = 0, last = -stable - 1;
+                               tree.for_each([&seen, &last, &readers_ok](int v)
+                                             {
+                                                 readers_ok = readers_ok && v > last;
+                                                 last = v;
+                                                 seen += v < 0;
+                                             });
+                               readers_ok = readers_ok && seen == stable;
+                           }
+                       });
+    for (std::thread &th : threads)
+        th.join();
+    reader.join();
+
+    bool ok = readers_ok && tree.size() == stable + nthreads * per_thread / 2;
+    for (int k = 0; ok && k < int(nthreads) * per_thread; ++k)
+        ok = tree.find(k) == ((k / int(nthreads)) % 2 == 1);
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned max_threads = std::thread::hardware_concurrency();
+    if (argc > 1)
+        max_threads = std::atoi(argv[1]);
+    if (max_threads == 0)
+        max_threads = 1;
+
+    std::cout << "stress: " << (stress(max_threads) ? "ok" : "FAILED") << std::endl;
+
+    std::cout << "threads\tconcurrent_bst Mops/s\tbst+mutex Mops/s" << std::endl;
+    for (unsigned n = 1; n <= max_threads; n *= 2)
+    {
+        cbst_int c;
+        locked_bst l;
+        std::mt19937 gen(42);
+        for (int i = 0; i < key_range / 2; ++i)
+        {
+            int k = int(gen() % key_range);
+            c.add(k);
+            l.tree.add(k);
+        }
+        double cm = run(c, n);
+        double lm = run(l, n);
+        std::cout << n << '\t' << cm << "\t\t\t" << lm << std::endl;
+    }
+    std::cout << "finds that hit: " << hits.load() << std::endl;
+    return 0;
+}
@@ -0,0 +1,1199 @@
+#ifndef CONCURRENT_BST_HPP
+#define CONCURRENT_BST_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "bst.hpp"
+
+/**
+ * @brief Albero binario di ricerca bilanciato utilizzabile da più thread contemporaneamente.
+ *
+ * Ha la stessa interfaccia di `bst` per i funtori `Comp` e `Equal`. È un albero AVL
+ * a bilanciamento rilassato con validazione ottimistica (Bronson et al., "A Practical
+ * Concurrent Binary Search Tree", PPoPP 2010):
+ * - le letture (`find`, `for_each`) non prendono lock: scendono l'albero leggendo una
+ *   versione per nodo e ripartono dal livello precedente se nel frattempo una rotazione
+ *   ha tolto chiavi dal sottoalbero in cui si trovano;
+ * - gli scrittori prendono solo i lock dei nodi che modificano (un nodo per un
+ *   inserimento, il genitore e il nodo per una rimozione, al più quattro nodi per una
+ *   rotazione), sempre dall'alto verso il basso;
+ * - un nodo rimosso con meno di due figli viene staccato subito; con due figli resta
+ *   come nodo di solo instradamento finché uno dei figli non sparisce.
+ *
+ * I nodi staccati vengono liberati con un recupero a epoche: ogni operazione entra
+ * nell'epoca corrente e un nodo staccato nell'epoca e viene liberato quando l'epoca
+ * globale arriva a e + 2, cioè quando nessuna operazione iniziata prima del distacco
+ * è ancora in corso. Il consumo di memoria resta quindi proporzionale ai valori
+ * presenti anche con chiavi sempre nuove; un thread fermo dentro un'operazione
+ * (per esempio in una `for_each` lunga) rimanda però il recupero.
+ *
+ * Le liste dei nodi staccati e il numero di valori sono divisi per gruppi di thread
+ * (le stesse strisce dei contatori di epoca): gli scrittori non condividono alcun lock
+ * o contatore globale, e solo il recupero prende un lock, senza mai attenderlo.
+ *
+ * L'altezza resta logaritmica anche con inserimenti ordinati. Le ricerche fanno un
+ * solo confronto per livello quando `Equal` è ricavata da `Comp` (vedi `bst_derived_equal`).
+ *
+ * @tparam T Il tipo di valore contenuto nei nodi dell'albero.
+ * @tparam Comp Il tipo di funzione di confronto per ordinare i nodi.
+ * @tparam Equal Il tipo di funzione di uguaglianza per confrontare i valori dei nodi
+ *               (di default ricavata da `Comp`, vedi `bst_equivalent`).
+ */
+template <typename T, typename Comp, typename Equal = bst_equivalent<Comp>>
+class concurrent_bst
+{
+    struct node;
+
+    /**
+     * @brief Parte di un nodo senza valore, condivisa con il nodo fittizio sopra la radice.
+     */
+    struct base
+    {
+        std::atomic<base *> parent;         //< puntatore al nodo genitore
+        std::atomic<node *> left;           //< puntatore al nodo figlio sinistro
+        std::atomic<node *> right;          //< puntatore al nodo figlio destro
+        std::atomic<std::uint64_t> version; //< versione per la validazione ottimistica (vedi shrinking)
+        std::atomic<int> height;            //< altezza del sottoalbero, aggiornata in modo rilassato
+        std::atomic<bool> present;          //< false se il valore è stato rimosso (nodo di instradamento)
+        std::atomic<bool> busy;             //< lock del nodo
+        node *next_retired;                 //< nodo successivo nella lista dei nodi staccati
+
+        /**
+         * @brief Costruttore della struttura base.
+         *
+         * @param h L'altezza iniziale.
+         * @param p True se il nodo contiene un valore.
+         */
+        base(int h, bool p)
+            : parent(nullptr), left(nullptr), right(nullptr), version(0), height(h), present(p), busy(false),
+              next_retired(nullptr) {}
+
+        node *child(bool r) const
+        {
+            return r ? right.load() : left.load();
+        }
+
+        void set_child(bool r, node *c)
+        {
+            if (r)
+                right.store(c);
+            else
+                left.store(c);
+        }
+
+        void lock()
+        {
+            while (busy.exchange(true, std::memory_order_acquire))
+                while (busy.load(std::memory_order_relaxed))
+                    std::this_thread::yield();
+        }
+
+        void unlock()
+        {
+            busy.store(false, std::memory_order_release);
+        }
+    };
+
+    /**
+     * @brief Struttura che rappresenta un nodo dell'albero.
+     */
+    struct node : base
+    {
+        const T value; //< valore del nodo, immutabile dopo la pubblicazione
+
+        /**
+         * @brief Costruttore della struttura node.
+         *
+         * @param v Il valore del nodo.
+         */
+        node(const T &v) : base(1, true), value(v) {}
+    };
+
+    typedef std::lock_guard<base> node_lock;
+
+    // bit di version: il nodo è stato staccato, oppure sta scendendo in una rotazione
+    // e il suo sottoalbero sta perdendo chiavi; i bit restanti contano le rotazioni
+    static constexpr std::uint64_t unlinked = 1;
+    static constexpr std::uint64_t shrinking = 2;
+    static constexpr std::uint64_t shrink_count = 4;
+
+    // esiti di condition oltre a una nuova altezza
+    static constexpr int unlink_required = -1;
+    static constexpr int rebalance_required = -2;
+    static constexpr int nothing_required = -3;
+
+    /**
+     * @brief Esito di un tentativo di modifica.
+     */
+    enum outcome
+    {
+        unchanged, //< il valore era già presente (inserimento) o assente (rimozione)
+        changed,   //< la modifica è avvenuta
+        retry      //< il tentativo va ripreso dal livello superiore
+    };
+
+    static constexpr unsigned int stripes = 32;           //< strisce di contatori e liste, per ridurre la contesa
+    static constexpr std::size_t collect_threshold = 64; //< nodi staccati in una striscia oltre i quali si tenta il recupero
+
+    /**
+     * @brief Contatore delle operazioni in corso in un'epoca, su una propria linea di cache.
+     */
+    struct alignas(64) epoch_counter
+    {
+        std::atomic<unsigned long> active{0};
+    };
+
+    /**
+     * @brief Stato degli scrittori di una striscia, su una propria linea di cache.
+     */
+    struct alignas(64) writer_stripe
+    {
+        std::atomic<node *> limbo[3] = {};     //< nodi staccati per epoca (modulo 3), da liberare
+        std::atomic<std::size_t> retired{0}; //< nodi nelle liste limbo
+        std::atomic<long> size{0};           //< valori aggiunti meno valori rimossi dai thread della striscia
+    };
+
+    base _holder;                              //< nodo fittizio: la radice è il suo figlio destro
+    std::atomic<std::uint64_t> _epoch;         //< epoca globale
+    mutable epoch_counter _active[3][stripes]; //< operazioni in corso per epoca (modulo 3)
+    writer_stripe _writers[stripes];           //< nodi staccati e numero di valori, per striscia
+    std::mutex _collect_lock;                  //< preso da un solo thread alla volta per avanzare _epoch
+    Comp _compare;                             //< funtore per il confronto tra i valori dei nodi
+    Equal _equal;                              //< funtore per l'uguaglianza tra i valori dei nodi
+
+    static constexpr bool derived_equal = bst_derived_equal<Comp, Equal>::value; //< Equal è l'equivalenza indotta da Comp
+
+    /**
+     * @brief Tiene il thread dentro l'epoca corrente per la durata di un'operazione.
+     *
+     * Finché esiste, nessun nodo raggiungibile all'inizio dell'operazione viene liberato.
+     */
+    class epoch_guard
+    {
+        std::atomic<unsigned long> *_counter;
+
+    public:
+        explicit epoch_guard(const concurrent_bst &b)
+        {
+            const unsigned int s = stripe();
+            while (true)
+            {
+                std::uint64_t e = b._epoch.load();
+                _counter = &b._active[e % 3][s].active;
+                _counter->fetch_add(1);
+                // se l'epoca è avanzata nel frattempo il contatore potrebbe essere già stato controllato
+                if (b._epoch.load() == e)
+                    return;
+                _counter->fetch_sub(1);
+            }
+        }
+
+        ~epoch_guard()
+        {
+            _counter->fetch_sub(1, std::memory_order_release);
+        }
+
+        epoch_guard(const epoch_guard &) = delete;
+        epoch_guard &operator=(const epoch_guard &) = delete;
+    };
+
+    /**
+     * @brief Restituisce il contatore di epoca assegnato al thread corrente.
+     */
+    static unsigned int stripe()
+    {
+        static std::atomic<unsigned int> next(0);
+        thread_local unsigned int mine = next.fetch_add(1, std::memory_order_relaxed) % stripes;
+        return mine;
+    }
+
+    static bool shrinking_or_unlinked(std::uint64_t v)
+    {
+        return (v & (shrinking | unlinked)) != 0;
+    }
+
+    static int height(const node *n)
+    {
+        return n == nullptr ? 0 : n->height.load();
+    }
+
+    /**
+     * @brief Aspetta che la rotazione che sta facendo scendere n finisca.
+     *
+     * @param n Il nodo.
+     * @param v La versione di n letta in precedenza.
+     */
+    static void wait_shrink(const base *n, std::uint64_t v)
+    {
+        if ((v & shrinking) == 0)
+            return;
+        for (int i = 0; i < 100; ++i)
+            if (n->version.load() != v)
+                return;
+        for (int i = 0; i < 10; ++i)
+        {
+            std::this_thread::yield();
+            if (n->version.load() != v)
+                return;
+        }
+        // la rotazione tiene il lock del nodo fino alla fine
+        const_cast<base *>(n)->lock();
+        const_cast<base *>(n)->unlock();
+    }
+
+    /**
+     * @brief Confronta un valore con quello di un nodo.
+     *
+     * @return Un numero negativo, zero o positivo se value precede, è uguale o segue quello del nodo.
+     */
+    int order(const T &value, const node *n) const
+    {
+        if constexpr (derived_equal)
+            return _compare(value, n->value) ? -1 : (_compare(n->value, value) ? 1 : 0);
+        else
+            return _equal(value, n->value) ? 0 : (_compare(value, n->value) ? -1 : 1);
+    }
+
+    /**
+     * @brief Passo di discesa di `find`.
+     *
+     * Con l'uguaglianza ricavata dal confronto fa un solo confronto per livello e
+     * ricorda come candidato l'ultimo nodo non maggiore del valore, come `bst::find_from`;
+     * altrimenti si ferma sul nodo uguale.
+     */
+    struct find_step
+    {
+        const concurrent_bst &tree;
+        const T &value;
+
+        int operator()(const node *n) const
+        {
+            if constexpr (!derived_equal)
+                if (tree._equal(value, n->value))
+                    return 0;
+            return tree._compare(value, n->value) ? -1 : 1;
+        }
+
+        bool marks(int dir) const
+        {
+            return derived_equal && dir > 0;
+        }
+    };
+
+    /**
+     * @brief Passo di discesa che cerca il primo nodo maggiore di un limite (tutti se il limite è nullptr).
+     */
+    struct above_step
+    {
+        const concurrent_bst &tree;
+        const T *bound;
+
+        int operator()(const node *n) const
+        {
+            return bound == nullptr || tree._compare(*bound, n->value) ? -1 : 1;
+        }
+
+        bool marks(int dir) const
+        {
+            return dir < 0;
+        }
+    };
+
+    /**
+     * @brief Scende da n fino a un figlio nullo, validando ogni passo con le versioni.
+     *
+     * Prima di passare a un figlio si controlla che la versione di n non sia cambiata:
+     * finché non cambia, nessuna rotazione ha tolto chiavi dal sottoalbero di n e la
+     * discesa fatta fin qui è ancora valida. Se è cambiata si torna al livello superiore.
+     *
+     * @param n Il nodo da cui scendere.
+     * @param v La versione di n letta prima di arrivarci.
+     * @param candidate L'ultimo nodo segnato dal passo (vedi Step::marks) sopra n.
+     * @param step Il passo: -1 o 1 per scendere a sinistra o a destra, 0 per fermarsi su n.
+     * @param result Il nodo su cui ci si è fermati, oppure l'ultimo nodo segnato.
+     * @return False se la discesa va ripresa dal livello superiore.
+     */
+    template <typename Step>
+    static bool descend(const node *n, std::uint64_t v, const node *candidate, const Step &step, const node *&result)
+    {
+        const int dir = step(n);
+        if (dir == 0)
+        {
+            result = n;
+            return true;
+        }
+        if (step.marks(dir))
+            candidate = n;
+        while (true)
+        {
+            const node *child = n->child(dir > 0);
+            if (child == nullptr)
+            {
+                if (n->version.load() != v)
+                    return false;
+                result = candidate;
+                return true;
+            }
+            std::uint64_t cv = child->version.load();
+            if (shrinking_or_unlinked(cv))
+            {
+                wait_shrink(child, cv);
+                if (n->version.load() != v)
+                    return false;
+            }
+            else if (child != n->child(dir > 0))
+            {
+                if (n->version.load() != v)
+                    return false;
+            }
+            else
+            {
+                if (n->version.load() != v)
+                    return false;
+                if (descend(child, cv, candidate, step, result))
+                    return true;
+            }
+        }
+    }
+
+    /**
+     * @brief Scende dalla radice con il passo indicato (vedi `descend`).
+     */
+    template <typename Step>
+    const node *search(const Step &step) const
+    {
+        while (true)
+        {
+            const node *root = _holder.right.load();
+            if (root == nullptr)
+                return nullptr;
+            std::uint64_t v = root->version.load();
+            if (shrinking_or_unlinked(v))
+                wait_shrink(root, v);
+            else if (root == _holder.right.load())
+            {
+                const node *result;
+                if (descend(root, v, nullptr, step, result))
+                    return result;
+            }
+        }
+    }
+
+    /**
+     * @brief Restituisce il primo valore presente maggiore di bound (il minimo se bound è nullptr).
+     *
+     * Va chiamata dentro un'epoca.
+     */
+    const node *next_present(const T *bound) const
+    {
+        while (true)
+        {
+            const node *n = search(above_step{*this, bound});
+            if (n == nullptr || n->present.load())
+                return n;
+            // nodo di instradamento o staccato: si prosegue dopo il suo valore
+            bound = &n->value;
+        }
+    }
+
+    /**
+     * @brief Stato di un nodo dopo una modifica.
+     *
+     * @return unlink_required se il nodo va staccato, rebalance_required se serve una
+     *         rotazione, nothing_required se è a posto, altrimenti l'altezza corretta.
+     */
+    static int condition(const base *n)
+    {
+        const node *l = n->left.load();
+        const node *r = n->right.load();
+        if ((l == nullptr || r == nullptr) && !n->present.load())
+            return unlink_required;
+
+        const int h = n->height.load();
+        const int hl = height(l);
+        const int hr = height(r);
+        // le letture non sono atomiche nel loro insieme: chi modifica un nodo si impegna
+        // a ripararlo, quindi se questa conclusione è sbagliata qualcun altro la correggerà
+        const int repl = 1 + std::max(hl, hr);
+        const int bal = hl - hr;
+        if (bal < -1 || bal > 1)
+            return rebalance_required;
+        return h != repl ? repl : nothing_required;
+    }
+
+    /**
+     * @brief Corregge l'altezza di n, con il lock di n.
+     *
+     * @return Il prossimo nodo da riparare, oppure nullptr.
+     */
+    static base *fix_height_nl(base *n)
+    {
+        const int c = condition(n);
+        switch (c)
+        {
+        case rebalance_required:
+        case unlink_required:
+            return n;
+        case nothing_required:
+            return nullptr;
+        default:
+            n->height.store(c);
+            return n->parent.load();
+        }
+    }
+
+    /**
+     * @brief Ripara le altezze e il bilanciamento risalendo da n verso la radice.
+     *
+     * Ogni riparazione indica il prossimo nodo da sistemare. Quando una rotazione indica un
+     * nodo più in basso, p e i suoi antenati possono avere ancora l'altezza vecchia o essere
+     * sbilanciati: finita la catena si risale dall'ultimo nodo riparato per ricontrollarli.
+     *
+     * @param n Il primo nodo da riparare (può essere nullptr).
+     */
+    void fix_height_and_rebalance(base *n)
+    {
+        bool recheck = false;
+        base *last = nullptr;
+        while (true)
+        {
+            while (n != nullptr && n->parent.load() != nullptr)
+            {
+                const int c = condition(n);
+                if (c == nothing_required || n->version.load() == unlinked)
+                    break;
+
+                last = n;
+                if (c != unlink_required && c != rebalance_required)
+                {
+                    node_lock l(*n);
+                    n = fix_height_nl(n);
+                }
+                else
+                {
+                    base *p = n->parent.load();
+                    node_lock lp(*p);
+                    if (p->version.load() != unlinked && n->parent.load() == p)
+                    {
+                        node_lock ln(*n);
+                        n = rebalance_nl(p, static_cast<node *>(n));
+                        recheck = recheck || (n != nullptr && n != p && n != p->parent.load());
+                    }
+                }
+            }
+            if (!recheck)
+                return;
+            recheck = false;
+            n = nullptr;
+            for (base *a = last->parent.load(); a != nullptr && a->parent.load() != nullptr; a = a->parent.load())
+                if (condition(a) != nothing_required)
+                {
+                    n = a;
+                    break;
+                }
+        }
+    }
+
+    /**
+     * @brief Stacca n, che ha al più un figlio, dal genitore p. Servono i lock di p e di n.
+     *
+     * @return False se n non è più figlio di p o ha due figli.
+     */
+    bool attempt_unlink_nl(base *p, node *n)
+    {
+        node *pl = p->left.load();
+        node *pr = p->right.load();
+        if (pl != n && pr != n)
+            return false;
+
+        node *l = n->left.load();
+        node *r = n->right.load();
+        if (l != nullptr && r != nullptr)
+            return false;
+        node *splice = l != nullptr ? l : r;
+
+        if (pl == n)
+            p->left.store(splice);
+        else
+            p->right.store(splice);
+        if (splice != nullptr)
+            splice->parent.store(p);
+
+        n->version.store(unlinked);
+        n->present.store(false);
+        retire(n);
+        return true;
+    }
+
+    /**
+     * @brief Ripara n, con i lock di p e di n: lo stacca, lo ruota o ne corregge l'altezza.
+     *
+     * @return Il prossimo nodo da riparare, oppure nullptr.
+     */
+    base *rebalance_nl(base *p, node *n)
+    {
+        node *l = n->left.load();
+        node *r = n->right.load();
+        if ((l == nullptr || r == nullptr) && !n->present.load())
+            return attempt_unlink_nl(p, n) ? fix_height_nl(p) : n;
+
+        const int h = n->height.load();
+        const int hl = height(l);
+        const int hr = height(r);
+        const int repl = 1 + std::max(hl, hr);
+        const int bal = hl - hr;
+
+        if (bal > 1)
+            return rebalance_to_right_nl(p, n, l, hr);
+        if (bal < -1)
+            return rebalance_to_left_nl(p, n, r, hl);
+        if (repl != h)
+        {
+            n->height.store(repl);
+            return fix_height_nl(p);
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Il figlio sinistro l di n è troppo alto: rotazione a destra, doppia se serve.
+     */
+    base *rebalance_to_right_nl(base *p, node *n, node *l, int hr)
+    {
+        node_lock ll(*l);
+        if (l->height.load() - hr <= 1)
+            return n;
+        node *lr = l->right.load();
+        const int hll = height(l->left.load());
+        const int hlr0 = height(lr);
+        if (hll >= hlr0)
+            return rotate_right_nl(p, n, l, hr, hll, lr, hlr0);
+        {
+            node_lock llr(*lr);
+            const int hlr = lr->height.load();
+            if (hll >= hlr)
+                return rotate_right_nl(p, n, l, hr, hll, lr, hlr);
+            // la doppia rotazione solo se lascia l bilanciato,
+            // altrimenti si ruota prima l da solo e n verrà sistemato dopo
+            const int hlrl = height(lr->left.load());
+            const int b = hll - hlrl;
+            if (b >= -1 && b <= 1)
+                return rotate_right_over_left_nl(p, n, l, hr, hll, lr, hlrl);
+        }
+        return rebalance_to_left_nl(n, l, lr, hll);
+    }
+
+    /**
+     * @brief Il figlio destro r di n è troppo alto: rotazione a sinistra, doppia se serve.
+     */
+    base *rebalance_to_left_nl(base *p, node *n, node *r, int hl)
+    {
+        node_lock lr(*r);
+        if (hl - r->height.load() >= -1)
+            return n;
+        node *rl = r->left.load();
+        const int hrl0 = height(rl);
+        const int hrr = height(r->right.load());
+        if (hrr >= hrl0)
+            return rotate_left_nl(p, n, hl, r, rl, hrl0, hrr);
+        {
+            node_lock lrl(*rl);
+            const int hrl = rl->height.load();
+            if (hrr >= hrl)
+                return rotate_left_nl(p, n, hl, r, rl, hrl, hrr);
+            const int hrlr = height(rl->right.load());
+            const int b = hrr - hrlr;
+            if (b >= -1 && b <= 1)
+                return rotate_left_over_right_nl(p, n, hl, r, rl, hrr, hrlr);
+        }
+        return rebalance_to_right_nl(n, r, rl, hrr);
+    }
+
+    /**
+     * @brief Fa salire l al posto di n. Servono i lock di p, n e l.
+     *
+     * @return Il prossimo nodo da riparare, oppure nullptr.
+     */
+    base *rotate_right_nl(base *p, node *n, node *l, int hr, int hll, node *lr, int hlr)
+    {
+        const std::uint64_t v = n->version.load();
+        node *pl = p->left.load();
+
+        n->version.store(v | shrinking);
+
+        n->left.store(lr);
+        if (lr != nullptr)
+            lr->parent.store(n);
+        l->right.store(n);
+        n->parent.store(l);
+        if (pl == n)
+            p->left.store(l);
+        else
+            p->right.store(l);
+        l->parent.store(p);
+
+        const int hn = 1 + std::max(hlr, hr);
+        n->height.store(hn);
+        l->height.store(1 + std::max(hll, hn));
+
+        n->version.store(v + shrink_count);
+
+        // si ripara quanto possibile con i lock già presi, dal nodo più profondo
+        if (hlr - hr < -1 || hlr - hr > 1)
+            return n;
+        if ((lr == nullptr || hr == 0) && !n->present.load())
+            return n;
+        if (hll - hn < -1 || hll - hn > 1)
+            return l;
+        if (hll == 0 && !l->present.load())
+            return l;
+        return fix_height_nl(p);
+    }
+
+    /**
+     * @brief Fa salire r al posto di n. Servono i lock di p, n e r.
+     *
+     * @return Il prossimo nodo da riparare, oppure nullptr.
+     */
+    base *rotate_left_nl(base *p, node *n, int hl, node *r, node *rl, int hrl, int hrr)
+    {
+        const std::uint64_t v = n->version.load();
+        node *pl = p->left.load();
+
+        n->version.store(v | shrinking);
+
+        n->right.store(rl);
+        if (rl != nullptr)
+            rl->parent.store(n);
+        r->left.store(n);
+        n->parent.store(r);
+        if (pl == n)
+            p->left.store(r);
+        else
+            p->right.store(r);
+        r->parent.store(p);
+
+        const int hn = 1 + std::max(hl, hrl);
+        n->height.store(hn);
+        r->height.store(1 + std::max(hn, hrr));
+
+        n->version.store(v + shrink_count);
+
+        if (hrl - hl < -1 || hrl - hl > 1)
+            return n;
+        if ((rl == nullptr || hl == 0) && !n->present.load())
+            return n;
+        if (hrr - hn < -1 || hrr - hn > 1)
+            return r;
+        if (hrr == 0 && !r->present.load())
+            return r;
+        return fix_height_nl(p);
+    }
+
+    /**
+     * @brief Doppia rotazione: fa salire lr, figlio destro di l, al posto di n. Servono i lock di p, n, l e lr.
+     *
+     * @return Il prossimo nodo da riparare, oppure nullptr.
+     */
+    base *rotate_right_over_left_nl(base *p, node *n, node *l, int hr, int hll, node *lr, int hlrl)
+    {
+        const std::uint64_t v = n->version.load();
+        const std::uint64_t lv = l->version.load();
+        node *pl = p->left.load();
+        node *lrl = lr->left.load();
+        node *lrr = lr->right.load();
+        const int hlrr = height(lrr);
+
+        n->version.store(v | shrinking);
+        l->version.store(lv | shrinking);
+
+        n->left.store(lrr);
+        if (lrr != nullptr)
+            lrr->parent.store(n);
+        l->right.store(lrl);
+        if (lrl != nullptr)
+            lrl->parent.store(l);
+        lr->left.store(l);
+        l->parent.store(lr);
+        lr->right.store(n);
+        n->parent.store(lr);
+        if (pl == n)
+            p->left.store(lr);
+        else
+            p->right.store(lr);
+        lr->parent.store(p);
+
+        const int hn = 1 + std::max(hlrr, hr);
+        n->height.store(hn);
+        int hl = 1 + std::max(hll, hlrl);
+        l->height.store(hl);
+
+        n->version.store(v + shrink_count);
+        l->version.store(lv + shrink_count);
+
+        // l senza valore e con un solo figlio non serve più: si stacca subito, con i lock già presi
+        if ((hll == 0 || hlrl == 0) && !l->present.load() && attempt_unlink_nl(lr, l))
+            hl = std::max(hll, hlrl);
+        lr->height.store(1 + std::max(hl, hn));
+
+        if (hlrr - hr < -1 || hlrr - hr > 1)
+            return n;
+        if ((lrr == nullptr || hr == 0) && !n->present.load())
+            return n;
+        if (hl - hn < -1 || hl - hn > 1)
+            return lr;
+        return fix_height_nl(p);
+    }
+
+    /**
+     * @brief Doppia rotazione: fa salire rl, figlio sinistro di r, al posto di n. Servono i lock di p, n, r e rl.
+     *
+     * @return Il prossimo nodo da riparare, oppure nullptr.
+     */
+    base *rotate_left_over_right_nl(base *p, node *n, int hl, node *r, node *rl, int hrr, int hrlr)
+    {
+        const std::uint64_t v = n->version.load();
+        const std::uint64_t rv = r->version.load();
+        node *pl = p->left.load();
+        node *rll = rl->left.load();
+        node *rlr = rl->right.load();
+        const int hrll = height(rll);
+
+        n->version.store(v | shrinking);
+        r->version.store(rv | shrinking);
+
+        n->right.store(rll);
+        if (rll != nullptr)
+            rll->parent.store(n);
+        r->left.store(rlr);
+        if (rlr != nullptr)
+            rlr->parent.store(r);
+        rl->right.store(r);
+        r->parent.store(rl);
+        rl->left.store(n);
+        n->parent.store(rl);
+        if (pl == n)
+            p->left.store(rl);
+        else
+            p->right.store(rl);
+        rl->parent.store(p);
+
+        const int hn = 1 + std::max(hl, hrll);
+        n->height.store(hn);
+        int hr = 1 + std::max(hrlr, hrr);
+        r->height.store(hr);
+
+        n->version.store(v + shrink_count);
+        r->version.store(rv + shrink_count);
+
+        if ((hrr == 0 || hrlr == 0) && !r->present.load() && attempt_unlink_nl(rl, r))
+            hr = std::max(hrlr, hrr);
+        rl->height.store(1 + std::max(hn, hr));
+
+        if (hrll - hl < -1 || hrll - hl > 1)
+            return n;
+        if ((rll == nullptr || hl == 0) && !n->present.load())
+            return n;
+        if (hr - hn < -1 || hr - hn > 1)
+            return rl;
+        return fix_height_nl(p);
+    }
+
+    /**
+     * @brief Aggiunge o rimuove il valore di un nodo già trovato.
+     *
+     * @param add True per un inserimento, false per una rimozione.
+     * @param p Il genitore di n al momento della discesa (serve solo per staccare n).
+     * @param n Il nodo con il valore cercato.
+     */
+    outcome attempt_node_update(bool add, base *p, node *n)
+    {
+        if (add)
+        {
+            if (n->present.load())
+                return unchanged;
+            // un nodo di instradamento torna a contenere il valore
+            node_lock l(*n);
+            if (n->version.load() == unlinked)
+                return retry;
+            if (n->present.load())
+                return unchanged;
+            n->present.store(true);
+            return changed;
+        }
+
+        if (!n->present.load())
+            return unchanged;
+        if (n->left.load() == nullptr || n->right.load() == nullptr)
+        {
+            base *damaged;
+            {
+                node_lock lp(*p);
+                if (p->version.load() == unlinked || n->parent.load() != p)
+                    return retry;
+                node_lock ln(*n);
+                if (!n->present.load())
+                    return unchanged;
+                if (!attempt_unlink_nl(p, n))
+                    return retry;
+                damaged = fix_height_nl(p);
+            }
+            fix_height_and_rebalance(damaged);
+            return changed;
+        }
+
+        node_lock l(*n);
+        if (n->version.load() == unlinked)
+            return retry;
+        if (!n->present.load())
+            return unchanged;
+        if (n->left.load() == nullptr || n->right.load() == nullptr)
+            return retry;
+        n->present.store(false);
+        return changed;
+    }
+
+    /**
+     * @brief Cerca value sotto n e lo aggiunge o lo rimuove (vedi `descend` per la validazione).
+     *
+     * @param value Il valore.
+     * @param spare Il nodo da agganciare in caso di inserimento, allocato solo al primo bisogno.
+     * @param p Il genitore di n.
+     * @param n Il nodo da cui scendere.
+     * @param v La versione di n letta prima di arrivarci.
+     */
+    outcome attempt_update(const T &value, std::unique_ptr<node> *spare, base *p, node *n, std::uint64_t v)
+    {
+        const int c = order(value, n);
+        if (c == 0)
+            return attempt_node_update(spare != nullptr, p, n);
+        const bool right = c > 0;
+
+        while (true)
+        {
+            node *child = n->child(right);
+            if (n->version.load() != v)
+                return retry;
+
+            if (child == nullptr)
+            {
+                if (spare == nullptr)
+                    return unchanged;
+                if (*spare == nullptr)
+                    *spare = std::unique_ptr<node>(new node(value));
+                base *damaged;
+                {
+                    node_lock l(*n);
+                    if (n->version.load() != v)
+                        return retry;
+                    if (n->child(right) != nullptr)
+                        continue; // un altro thread ha agganciato un nodo qui
+                    (*spare)->parent.store(n);
+                    n->set_child(right, spare->release());
+                    damaged = fix_height_nl(n);
+                }
+                fix_height_and_rebalance(damaged);
+                return changed;
+            }
+
+            std::uint64_t cv = child->version.load();
+            if (shrinking_or_unlinked(cv))
+                wait_shrink(child, cv);
+            else if (child == n->child(right))
+            {
+                if (n->version.load() != v)
+                    return retry;
+                outcome o = attempt_update(value, spare, n, child, cv);
+                if (o != retry)
+                    return o;
+            }
+        }
+    }
+
+    /**
+     * @brief Aggiunge (spare non nullo) o rimuove un valore, ripartendo dalla radice quando serve.
+     */
+    outcome update(const T &value, std::unique_ptr<node> *spare)
+    {
+        while (true)
+        {
+            node *root = _holder.right.load();
+            if (root == nullptr)
+            {
+                if (spare == nullptr)
+                    return unchanged;
+                if (*spare == nullptr)
+                    *spare = std::unique_ptr<node>(new node(value));
+                node_lock l(_holder);
+                if (_holder.right.load() == nullptr)
+                {
+                    (*spare)->parent.store(&_holder);
+                    _holder.right.store(spare->release());
+                    return changed;
+                }
+            }
+            else
+            {
+                std::uint64_t v = root->version.load();
+                if (shrinking_or_unlinked(v))
+                    wait_shrink(root, v);
+                else if (root == _holder.right.load())
+                {
+                    outcome o = attempt_update(value, spare, &_holder, root, v);
+                    if (o != retry)
+                        return o;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Mette un nodo appena staccato nella lista della striscia per l'epoca corrente.
+     *
+     * Va chiamata dentro l'epoca dell'operazione: finché l'operazione è in corso la lista
+     * in cui finisce il nodo non può essere svuotata da `collect`.
+     *
+     * @param n Il nodo staccato.
+     */
+    void retire(node *n)
+    {
+        writer_stripe &w = _writers[stripe()];
+        std::atomic<node *> &head = w.limbo[_epoch.load() % 3];
+        node *h = head.load(std::memory_order_relaxed);
+        do
+            n->next_retired = h;
+        while (!head.compare_exchange_weak(h, n, std::memory_order_release, std::memory_order_relaxed));
+        w.retired.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Libera una lista di nodi staccati.
+     *
+     * @return Il numero di nodi liberati.
+     */
+    static std::size_t free_list(node *n)
+    {
+        std::size_t freed = 0;
+        while (n != nullptr)
+        {
+            node *next = n->next_retired;
+            delete n;
+            n = next;
+            ++freed;
+        }
+        return freed;
+    }
+
+    /**
+     * @brief Prova ad avanzare l'epoca e libera i nodi staccati due epoche prima.
+     *
+     * Si chiama dopo essere usciti dall'epoca dell'operazione, che altrimenti potrebbe
+     * impedire l'avanzamento, e solo quando la striscia del thread ha accumulato abbastanza
+     * nodi. Se un altro thread sta già recuperando non fa nulla.
+     */
+    void collect()
+    {
+        if (_writers[stripe()].retired.load(std::memory_order_relaxed) < collect_threshold)
+            return;
+        std::unique_lock<std::mutex> l(_collect_lock, std::try_to_lock);
+        if (!l.owns_lock())
+            return;
+        const std::uint64_t e = _epoch.load();
+        // l'epoca avanza solo se nessuna operazione è ancora nell'epoca precedente
+        for (unsigned int s = 0; s < stripes; ++s)
+            if (_active[(e + 2) % 3][s].active.load() != 0)
+                return;
+        _epoch.store(e + 1);
+        // nessuna operazione può più aggiungere nodi alle liste dell'epoca e - 1
+        node *lists[stripes];
+        for (unsigned int s = 0; s < stripes; ++s)
+            lists[s] = _writers[s].limbo[(e + 2) % 3].exchange(nullptr, std::memory_order_acquire);
+        l.unlock();
+
+        for (unsigned int s = 0; s < stripes; ++s)
+            if (lists[s] != nullptr)
+                _writers[s].retired.fetch_sub(free_list(lists[s]), std::memory_order_relaxed);
+    }
+
+public:
+    /**
+     * @brief Costruttore di default: albero vuoto.
+     */
+    concurrent_bst() : _holder(0, false), _epoch(0) {}
+
+    concurrent_bst(const concurrent_bst &) = delete;
+    concurrent_bst &operator=(const concurrent_bst &) = delete;
+
+    /**
+     * @brief Distruttore. Non deve essere in corso alcuna operazione di altri thread.
+     */
+    ~concurrent_bst()
+    {
+        node *n = _holder.right.load(std::memory_order_relaxed);
+        while (n != nullptr)
+        {
+            node *l = n->left.load(std::memory_order_relaxed);
+            if (l != nullptr)
+            {
+                // rotazione a destra: il figlio sinistro sale, n scende a destra
+                n->left.store(l->right.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                l->right.store(n, std::memory_order_relaxed);
+                n = l;
+            }
+            else
+            {
+                node *r = n->right.load(std::memory_order_relaxed);
+                delete n;
+                n = r;
+            }
+        }
+        for (writer_stripe &w : _writers)
+            for (std::atomic<node *> &head : w.limbo)
+                free_list(head.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Aggiunge un valore all'albero.
+     *
+     * Se il valore è già presente l'albero resta invariato. Il nodo viene allocato solo
+     * quando si raggiunge un puntatore nullo.
+     *
+     * @param value Il valore da aggiungere all'albero.
+     * @return True se il valore è stato aggiunto da questa chiamata, false se era già presente.
+     *
+     * @throw Eccezione generata dall'allocazione o dalla copia del valore.
+     */
+    bool add(const T &value)
+    {
+        std::unique_ptr<node> spare;
+        outcome o;
+        {
+            epoch_guard g(*this);
+            o = update(value, &spare);
+        }
+        if (o == changed)
+            _writers[stripe()].size.fetch_add(1, std::memory_order_relaxed);
+        collect();
+        return o == changed;
+    }
+
+    /**
+     * @brief Rimuove un valore dall'albero.
+     *
+     * Il nodo viene staccato subito se ha al più un figlio e liberato quando nessuna
+     * operazione in corso può più raggiungerlo.
+     *
+     * @param value Il valore da rimuovere.
+     * @return True se il valore è stato rimosso da questa chiamata, false se non era presente.
+     */
+    bool erase(const T &value)
+    {
+        outcome o;
+        {
+            epoch_guard g(*this);
+            o = update(value, nullptr);
+        }
+        if (o == changed)
+            _writers[stripe()].size.fetch_sub(1, std::memory_order_relaxed);
+        collect();
+        return o == changed;
+    }
+
+    /**
+     * @brief Trova un valore nell'albero senza prendere lock.
+     *
+     * @param value Il valore da cercare nell'albero.
+     * @return True se il valore viene trovato, altrimenti false.
+     */
+    bool find(const T &value) const
+    {
+        epoch_guard g(*this);
+        const node *n = search(find_step{*this, value});
+        if constexpr (derived_equal)
+            if (n != nullptr && _compare(n->value, value))
+                return false;
+        return n != nullptr && n->present.load();
+    }
+
+    /**
+     * @brief Restituisce il numero di valori presenti nell'albero.
+     *
+     * Somma i contatori delle strisce: con scrittori attivi il risultato è solo indicativo.
+     *
+     * @return Il numero di valori presenti.
+     */
+    unsigned int size() const
+    {
+        long n = 0;
+        for (const writer_stripe &w : _writers)
+            n += w.size.load(std::memory_order_relaxed);
+        return n > 0 ? static_cast<unsigned int>(n) : 0;
+    }
+
+    /**
+     * @brief Chiama f su ogni valore presente, in ordine.
+     *
+     * La visita non prende lock: ogni passo cerca il primo valore maggiore dell'ultimo
+     * visitato. I valori aggiunti o rimossi durante la visita possono essere visti oppure no,
+     * ma ogni valore presente per tutta la durata della visita viene visto esattamente una volta.
+     * Per tutta la visita nessun nodo staccato viene liberato.
+     *
+     * @tparam F Il tipo della funzione, invocabile con `const T &`.
+     * @param f La funzione da chiamare.
+     */
+    template <typename F>
+    void for_each(F f) const
+    {
+        epoch_guard g(*this);
+        for (const node *n = next_present(nullptr); n != nullptr; n = next_present(&n->value))
+            f(n->value);
+    }
+
+    /**
+     * Funzione GLOBALE che implementa l'operatore di stream.
+     *
+     * @param os Lo stream di output su cui stampare i valori dei nodi.
+     * @param b L'albero da stampare.
+     * @return Lo stream di output su cui sono stati stampati i valori dei nodi.
+     */
+    friend std::ostream &operator<<(std::ostream &os, const concurrent_bst &b)
+    {
+        b.for_each([&os](const T &v)
+                   { os << v << ' '; });
+        return os;
+    }
+};
+
+/**
+ * Funzione GLOBALE che stampa a schermo i soli valori
+ * di un albero concorrente che soddisfano un predicato specificato dall'utente.
+ *
+ * @tparam T Il tipo degli elementi nell'albero.
+ * @tparam Comp Il funtore di confronto per ordinare gli elementi nell'albero.
+ * @tparam Equal Il funtore di confronto per verificare l'uguaglianza tra gli elementi.
+ * @tparam P Il tipo del predicato da utilizzare per filtrare gli elementi.
+ *
+ * @param b L'albero da stampare.
+ * @param pred Il predicato da utilizzare per filtrare gli elementi.
+ */
+template <typename T, typename Comp, typename Equal, typename P>
+void printIF(const concurrent_bst<T, Comp, Equal> &b, P pred)
+{
+    b.for_each([&pred](const T &v)
+               {
+                   if (pred(v))
+                   {
+                       std::cout << v << '\n';
+                   }
+               });
+    std::cout.flush();
+}
+
+#endif
@@ -0,0 +1,604 @@
+#ifndef FROZEN_BST_HPP
+#define FROZEN_BST_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BST_HAVE_MMAP 1
+#endif
+
+/**
+ * @brief Suggerisce al processore di caricare in cache l'indirizzo specificato.
+ *
+ * Sui compilatori che non supportano `__builtin_prefetch` non fa nulla.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define BST_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define BST_PREFETCH(addr) ((void)0)
+#endif
+
+/**
+ * @brief Indice immutabile e contiguo degli elementi di un albero binario di ricerca.
+ *
+ * Gli elementi sono memorizzati in un unico array secondo il layout di Eytzinger
+ * (ampiezza prima): il nodo in posizione k ha i figli in posizione 2k e 2k + 1
+ * (con indici a partire da 1). Non ci sono puntatori da seguire e i primi livelli,
+ * i più visitati, stanno nelle stesse linee di cache.
+ *
+ * La ricerca scende l'albero implicito senza salti condizionati (una chiamata a `Comp`
+ * per livello) e carica in anticipo i nodi di quattro livelli più in basso.
+ *
+ * Si ottiene tipicamente con `bst::freeze()`. Per i tipi banalmente copiabili l'indice
+ * può essere salvato in formato binario con `save()` e riaperto con `map()`, che mappa
+ * il file in memoria in sola lettura: nessuna lettura elemento per elemento e nessuna
+ * allocazione per nodo.
+ *
+ * @tparam T Il tipo di valore contenuto nell'indice.
+ * @tparam Comp Il tipo di funzione di confronto per ordinare i valori.
+ * @tparam Equal Il tipo di funzione di uguaglianza per confrontare i valori.
+ */
+template <typename T, typename Comp, typename Equal>
+class frozen_bst
+{
+    std::vector<T> _keys;                 //< valori posseduti dall'indice (vuoto se mappato da file)
+    std::shared_ptr<const void> _mapping; //< mappatura del file che contiene i valori, se presente
+    const T *_data;                       //< valori in layout di Eytzinger: _data[k - 1] è il nodo k
+    std::size_t _size;                    //< numero di valori
+    Comp _compare;                        //< funtore per il confronto tra i valori
+    Equal _equal;                         //< funtore per l'uguaglianza tra i valori
+
+    /**
+     * @brief Intestazione del formato binario, seguita dai valori nel layout di Eytzinger.
+     *
+     * È lunga 64 byte, quindi i valori mappati restano allineati per ogni `T` con
+     * allineamento fino a 64.
+     */
+    struct file_header
+    {
+        char magic[8];              //< "BSTFROZ" seguito da '\0'
+        std::uint32_t version;      //< versione del formato
+        std::uint32_t byte_order;   //< file_byte_order scritto nell'ordine dei byte di chi ha salvato
+        std::uint64_t value_size;   //< sizeof(T)
+        std::uint64_t count;        //< numero di valori
+        unsigned char reserved[32]; //< zeri
+    };
+
+    static_assert(sizeof(file_header) == 64, "l'intestazione deve occupare 64 byte");
+
+    static constexpr std::uint32_t file_version = 1;             //< versione scritta da save
+    static constexpr std::uint32_t file_byte_order = 0x01020304; //< rileva file di macchine con ordine diverso
+
+    /**
+     * @brief Verifica che T possa essere salvato copiandone i byte.
+     */
+    static void check_serializable()
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "save/load richiedono un tipo banalmente copiabile");
+        static_assert(alignof(T) <= sizeof(file_header), "allineamento di T troppo grande per il formato");
+    }
+
+    /**
+     * @brief Controlla un'intestazione letta da file.
+     *
+     * @param h L'intestazione.
+     * @param bytes I byte disponibili dopo l'intestazione.
+     *
+     * @throw std::runtime_error se il file non è un indice di questo tipo o è troncato.
+     */
+    static void check_header(const file_header &h, std::uint64_t bytes)
+    {
+        if (std::memcmp(h.magic, "BSTFROZ", 8) != 0 || h.version != file_version)
+            throw std::runtime_error("frozen_bst: formato del file non riconosciuto");
+        if (h.byte_order != file_byte_order || h.value_size != sizeof(T))
+            throw std::runtime_error("frozen_bst: file salvato con un tipo o un ordine dei byte diverso");
+        if (h.count > bytes / sizeof(T))
+            throw std::runtime_error("frozen_bst: file troncato");
+    }
+
+    /**
+     * @brief Restituisce i byte rimasti da leggere in uno stream.
+     *
+     * @param is Lo stream, lasciato nella posizione corrente.
+     * @return I byte rimasti, oppure UINT64_MAX se lo stream non è posizionabile.
+     */
+    static std::uint64_t remaining(std::istream &is)
+    {
+        const std::istream::pos_type here = is.tellg();
+        if (here == std::istream::pos_type(-1))
+            return UINT64_MAX;
+        is.seekg(0, std::ios::end);
+        const std::istream::pos_type end = is.tellg();
+        is.clear();
+        is.seekg(here);
+        if (end == std::istream::pos_type(-1) || end < here)
+            return UINT64_MAX;
+        return static_cast<std::uint64_t>(end - here);
+    }
+
+    /**
+     * @brief Restituisce la posizione del primo nodo in ordine a partire dal nodo k.
+     *
+     * @param k La posizione di partenza (1 per l'intero indice).
+     * @param n Il numero di elementi dell'indice.
+     * @return La posizione del nodo più a sinistra del sottoalbero di k, 0 se l'indice è vuoto.
+     */
+    static std::size_t first(std::size_t k, std::size_t n)
+    {
+        if (k > n)
+            return 0;
+        while (2 * k <= n)
+            k = 2 * k;
+        return k;
+    }
+
+    /**
+     * @brief Restituisce la posizione del successore in ordine del nodo k.
+     *
+     * @param k La posizione di un nodo esistente.
+     * @param n Il numero di elementi dell'indice.
+     * @return La posizione del successore, 0 se k è l'ultimo elemento.
+     */
+    static std::size_t next(std::size_t k, std::size_t n)
+    {
+        if (2 * k + 1 <= n)
+            return first(2 * k + 1, n);
+        while (k & 1)
+            k >>= 1;
+        return k >> 1;
+    }
+
+    /**
+     * @brief Cerca una chiave nell'albero implicito.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da cercare.
+     * @return True se un valore equivalente alla chiave viene trovato, altrimenti false.
+     */
+    template <typename K>
+    bool find_key(const K &key) const
+    {
+        const T *keys = _data;
+        const std::size_t n = _size;
+        std::size_t k = 1;
+        while (k <= n)
+        {
+            if (16 * k <= n)
+                BST_PREFETCH(keys + 16 * k - 1);
+            k = 2 * k + _compare(keys[k - 1], key);
+        }
+        // si risale oltre le svolte a destra finali: resta il primo nodo non minore di key
+        while (k & 1)
+            k >>= 1;
+        k >>= 1;
+        return k != 0 && _equal(keys[k - 1], key);
+    }
+
+public:
+    /**
+     * @brief Costruttore di default: indice vuoto.
+     */
+    frozen_bst() : _data(nullptr), _size(0) {}
+
+    /**
+     * @brief Costruisce l'indice a partire da una sequenza ordinata di n elementi distinti.
+     *
+     * @tparam Iter Il tipo dell'iteratore.
+     * @param begin L'iteratore di inizio della sequenza.
+     * @param end L'iteratore di fine della sequenza.
+     * @param n Il numero di elementi della sequenza.
+     *
+     * @pre La sequenza è ordinata in modo strettamente crescente secondo `Comp`.
+     *
+     * @throw Eccezione generata dall'allocazione o dalla copia dei valori.
+     */
+    template <typename Iter>
+    frozen_bst(Iter begin, Iter end, std::size_t n) : _data(nullptr), _size(0)
+    {
+        std::vector<const T *> sorted;
+        sorted.reserve(n);
+        for (; begin != end; ++begin)
+            sorted.push_back(&*begin);
+        n = sorted.size();
+
+        // rank[k] = posizione in ordine del nodo k dell'albero implicito
+        std::vector<std::size_t> rank(n + 1);
+        std::size_t i = 0;
+        for (std::size_t k = first(1, n); k != 0; k = next(k, n))
+            rank[k] = i++;
+
+        _keys.reserve(n);
+        for (std::size_t k = 1; k <= n; ++k)
+            _keys.push_back(*sorted[rank[k]]);
+        _data = _keys.data();
+        _size = n;
+    }
+
+    /**
+     * @brief Copy constructor
+     *
+     * Un indice mappato da file condivide la mappatura con la copia.
+     *
+     * @param other L'indice da copiare.
+     */
+    frozen_bst(const frozen_bst &other)
+        : _keys(other._keys), _mapping(other._mapping),
+          _data(_mapping != nullptr ? other._data : _keys.data()), _size(other._size) {}
+
+    /**
+     * @brief Move constructor
+     *
+     * @param other L'indice da cui spostare i valori, che resta vuoto.
+     */
+    frozen_bst(frozen_bst &&other) noexcept : frozen_bst()
+    {
+        swap(other);
+    }
+
+    /**
+     * @brief Operatore assegnazione
+     *
+     * @param other L'indice da copiare (per valore).
+     * @return reference all'istanza corrente.
+     */
+    frozen_bst &operator=(frozen_bst other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    /**
+     * @brief Scambia il contenuto di due indici.
+     *
+     * @param other L'indice con cui scambiare il contenuto.
+     */
+    void swap(frozen_bst &other) noexcept
+    {
+        _keys.swap(other._keys);
+        _mapping.swap(other._mapping);
+        std::swap(_data, other._data);
+        std::swap(_size, other._size);
+    }
+
+    /**
+     * @brief Scrive l'indice in formato binario: un'intestazione seguita dall'array dei valori.
+     *
+     * Disponibile solo se `T` è banalmente copiabile. Il file può essere riletto solo su
+     * macchine con lo stesso ordine dei byte e la stessa rappresentazione di `T`.
+     * Gli errori di scrittura sono segnalati dallo stato dello stream.
+     *
+     * @param os Lo stream binario su cui scrivere.
+     */
+    void save(std::ostream &os) const
+    {
+        check_serializable();
+        file_header h = {};
+        std::memcpy(h.magic, "BSTFROZ", 8);
+        h.version = file_version;
+        h.byte_order = file_byte_order;
+        h.value_size = sizeof(T);
+        h.count = _size;
+        os.write(reinterpret_cast<const char *>(&h), sizeof(h));
+        os.write(reinterpret_cast<const char *>(_data), static_cast<std::streamsize>(_size * sizeof(T)));
+    }
+
+    /**
+     * @brief Legge un indice scritto da `save()` copiando i valori in memoria.
+     *
+     * Richiede che `T` sia anche costruibile di default. Il numero di valori dichiarato
+     * nell'intestazione viene confrontato con la lunghezza dello stream prima di allocare;
+     * se lo stream non è posizionabile i valori vengono letti a blocchi, così un'intestazione
+     * corrotta non fa allocare più memoria dei dati effettivamente presenti.
+     *
+     * @param is Lo stream binario da cui leggere.
+     * @return L'indice letto.
+     *
+     * @throw std::runtime_error se i dati non sono un indice di questo tipo o sono troncati.
+     * @throw std::bad_alloc se l'allocazione fallisce.
+     */
+    static frozen_bst load(std::istream &is)
+    {
+        check_serializable();
+        file_header h;
+        if (!is.read(reinterpret_cast<char *>(&h), sizeof(h)))
+            throw std::runtime_error("frozen_bst: file troncato");
+        const std::uint64_t bytes = remaining(is);
+        check_header(h, bytes);
+
+        frozen_bst f;
+        if (bytes != UINT64_MAX)
+            f._keys.reserve(static_cast<std::size_t>(h.count));
+        const std::size_t chunk = std::max<std::size_t>(1, (std::size_t(1) << 20) / sizeof(T));
+        while (f._keys.size() < h.count)
+        {
+            const std::size_t done = f._keys.size();
+            const std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(chunk, h.count - done));
+            f._keys.resize(done + n);
+            if (!is.read(reinterpret_cast<char *>(f._keys.data() + done), static_cast<std::streamsize>(n * sizeof(T))))
+                throw std::runtime_error("frozen_bst: file troncato");
+        }
+        f._data = f._keys.data();
+        f._size = f._keys.size();
+        return f;
+    }
+
+    /**
+     * @brief Apre in sola lettura un file scritto da `save()`, senza copiarne i valori.
+     *
+     * Sui sistemi POSIX il file viene mappato in memoria con `mmap` e l'indice legge
+     * direttamente dalle pagine del file, caricate dal sistema operativo solo quando
+     * servono; la mappatura resta valida finché esiste una copia dell'indice.
+     * Sugli altri sistemi il file viene letto con `load()`.
+     *
+     * @param path Il percorso del file.
+     * @return L'indice mappato.
+     *
+     * @throw std::system_error se il file non può essere aperto o mappato.
+     * @throw std::runtime_error se il file non è un indice di questo tipo o è troncato.
+     */
+    static frozen_bst map(const char *path)
+    {
+        check_serializable();
+#ifdef BST_HAVE_MMAP
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0)
+        {
+            int err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), path);
+        }
+        std::size_t length = static_cast<std::size_t>(st.st_size);
+        if (length < sizeof(file_header))
+        {
+            ::close(fd);
+            throw std::runtime_error("frozen_bst: file troncato");
+        }
+        void *addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        int err = errno;
+        ::close(fd);
+        if (addr == MAP_FAILED)
+            throw std::system_error(err, std::generic_category(), path);
+
+        std::shared_ptr<const void> mapping;
+        try
+        {
+            mapping.reset(addr, [length](const void *p)
+                          { ::munmap(const_cast<void *>(p), length); });
+        }
+        catch (...)
+        {
+            ::munmap(addr, length);
+            throw;
+        }
+        const file_header *h = static_cast<const file_header *>(addr);
+        check_header(*h, length - sizeof(file_header));
+
+        frozen_bst f;
+        f._mapping = std::move(mapping);
+        f._data = reinterpret_cast<const T *>(static_cast<const char *>(addr) + sizeof(file_header));
+        f._size = static_cast<std::size_t>(h->count);
+        return f;
+#else
+        std::ifstream is(path, std::ios::binary);
+        if (!is)
+            throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), path);
+        return load(is);
+#endif
+    }
+
+    /**
+     * @brief Restituisce il numero di elementi dell'indice.
+     *
+     * @return Il numero di elementi.
+     */
+    std::size_t size() const
+    {
+        return _size;
+    }
+
+    /**
+     * @brief Trova un valore nell'indice.
+     *
+     * @param value Il valore da cercare.
+     * @return True se il valore viene trovato, altrimenti false.
+     */
+    bool find(const T &value) const
+    {
+        return find_key(value);
+    }
+
+    /**
+     * @brief Trova un valore nell'indice a partire da una chiave di tipo diverso da `T`.
+     *
+     * Disponibile solo se `Comp` dichiara `is_transparent`.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da cercare.
+     * @return True se un valore equivalente alla chiave viene trovato, altrimenti false.
+     */
+    template <typename K, typename C = Comp, typename = typename C::is_transparent>
+    bool find(const K &key) const
+    {
+        return find_key(key);
+    }
+
+    /**
+     * Funzione GLOBALE che implementa l'operatore di stream.
+     *
+     * @param os Lo stream di output su cui stampare i valori.
+     * @param f L'indice da stampare.
+     * @return Lo stream di output su cui sono stati stampati i valori.
+     */
+    friend std::ostream &operator<<(std::ostream &os, const frozen_bst &f)
+    {
+        for (const_iterator i = f.begin(), ie = f.end(); i != ie; ++i)
+            os << *i << ' ';
+        return os;
+    }
+
+    /**
+     * Classe che rappresenta un iteratore costante (in ordine) per la classe frozen_bst.
+     */
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const T *pointer;
+        typedef const T &reference;
+
+        /**
+         * @brief Costruttore di default.
+         */
+        const_iterator() : keys(nullptr), n(0), k(0) {}
+
+        /**
+         * @brief Operatore di dereferenziazione.
+         *
+         * @return Il riferimento costante all'elemento puntato dall'iteratore.
+         */
+        reference operator*() const
+        {
+            return keys[k - 1];
+        }
+
+        /**
+         * @brief Operatore di accesso ai membri.
+         *
+         * @return Il puntatore costante all'elemento puntato dall'iteratore.
+         */
+        pointer operator->() const
+        {
+            return keys + (k - 1);
+        }
+
+        /**
+         * @brief Operatore di post-incremento.
+         *
+         * @return Un iteratore costante che punta all'elemento precedente.
+         */
+        const_iterator operator++(int)
+        {
+            const_iterator tmp(*this);
+            k = next(k, n);
+            return tmp;
+        }
+
+        /**
+         * @brief Operatore di pre-incremento.
+         *
+         * @return Un riferimento a se stesso.
+         */
+        const_iterator &operator++()
+        {
+            k = next(k, n);
+            return *this;
+        }
+
+        /**
+         * @brief Operatore di uguaglianza.
+         *
+         * @param other L'iteratore da confrontare.
+         * @return True se gli iteratori sono uguali, false altrimenti.
+         */
+        bool operator==(const const_iterator &other) const
+        {
+            return k == other.k;
+        }
+
+        /**
+         * @brief Operatore di disuguaglianza.
+         *
+         * @param other L'iteratore da confrontare.
+         * @return True se gli iteratori sono diversi, false altrimenti.
+         */
+        bool operator!=(const const_iterator &other) const
+        {
+            return !(other == *this);
+        }
+
+    private:
+        const T *keys;
+        std::size_t n;
+        std::size_t k;
+
+        friend class frozen_bst;
+
+        /**
+         * @brief Costruttore privato.
+         *
+         * @param keys L'array dei valori dell'indice.
+         * @param n Il numero di elementi dell'indice.
+         * @param k La posizione del nodo (0 per la fine).
+         */
+        const_iterator(const T *keys, std::size_t n, std::size_t k) : keys(keys), n(n), k(k) {}
+    };
+
+    /**
+     * @brief Restituisce un iteratore costante che punta all'elemento minimo dell'indice.
+     *
+     * @return Un iteratore costante che punta all'inizio dell'indice.
+     */
+    const_iterator begin() const
+    {
+        return const_iterator(_data, _size, first(1, _size));
+    }
+
+    /**
+     * @brief Restituisce un iteratore costante che punta alla fine dell'indice.
+     *
+     * @return Un iteratore costante che punta alla fine dell'indice.
+     */
+    const_iterator end() const
+    {
+        return const_iterator(_data, _size, 0);
+    }
+};
+
+/**
+ * Funzione GLOBALE che stampa a schermo i soli valori
+ * di un indice congelato che soddisfano un predicato specificato dall'utente.
+ *
+ * @tparam T Il tipo degli elementi nell'indice.
+ * @tparam Comp Il funtore di confronto per ordinare gli elementi.
+ * @tparam Equal Il funtore di confronto per verificare l'uguaglianza tra gli elementi.
+ * @tparam P Il tipo del predicato da utilizzare per filtrare gli elementi.
+ *
+ * @param f L'indice da stampare.
+ * @param pred Il predicato da utilizzare per filtrare gli elementi.
+ */
+template <typename T, typename Comp, typename Equal, typename P>
+void printIF(const frozen_bst<T, Comp, Equal> &f, P pred)
+{
+    typename frozen_bst<T, Comp, Equal>::const_iterator i, ie;
+    for (i = f.begin(), ie = f.end(); i != ie; ++i)
+    {
+        if (pred(*i))
+        {
+            std::cout << *i << '\n';
+        }
+    }
+    std::cout.flush();
+}
+
+#endif
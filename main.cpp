@@ -1,384 +1,812 @@
-/**
- * @file main.cpp
- * 
- * @brief Test d'uso della classe bst templata
- */
-#include <iostream>
-
-#include "bst.hpp"
-
-/**
- * @brief Funtore di ordinamento tra tipi interi
- * 
- * Ordina due interi in ordine crescente.
- */
-struct compare_int
-{
-    bool operator()(int a, int b) const
-    {
-        return a < b;
-    }
-};
-
-/**
- * @brief Funtore di uguaglianza tra tipi interi
- * 
- * Valuta l'uglianza tra due interi.
- */
-struct equal_int
-{
-    bool operator()(int a, int b) const
-    {
-        return a == b;
-    }
-};
-
-/**
- * @brief Funtore di ordinamento tra tipi char
- * 
- * Ordina due char in ordine crescente.
- */
-struct compare_char
-{
-    bool operator()(char a, char b) const
-    {
-        return a < b;
-    }
-};
-
-/**
- * @brief Funtore di uguaglianza tra tipi char
- * 
- * Valuta l'uglianza tra due char.
- */
-struct equal_char
-{
-    bool operator()(char a, char b) const
-    {
-        return a == b;
-    }
-};
-
-/**
- * @brief Funtore di ordinamento tra tipi team
- * 
- * Ordina due team in ordine crescente.
- */
-struct team
-{
-    std::string name;
-    int position;
-
-    team(std::string n, int p) : name(n), position(p) {}
-};
-
-/**
- * @brief Funtore di ordinamento tra tipi team
- * 
- * Ordina due team in ordine crescente.
- */
-struct compare_team
-{
-    bool operator()(team a, team b) const
-    {
-        return a.position < b.position;
-    }
-};
-
-/**
- * @brief Funtore di uguaglianza tra tipi team
- * 
- * Valuta l'uglianza tra due team.
- */
-struct equal_team
-{
-    bool operator()(team a, team b) const
-    {
-        return a.position == b.position;
-    }
-};
-
-/**
- * @brief Operatore di output per team
- * 
- * Stampa il nome e la posizione della squadra.
- */
-std::ostream &operator<<(std::ostream &os, const team &t)
-{
-    std::cout << t.position << ") " << t.name;
-    return os;
-}
-
-
-// typedef della classe su interi di comodo
-typedef bst<int, compare_int, equal_int> bst_int;
-
-// typedef della classe su char di comodo
-typedef bst<char, compare_char, equal_char> bst_char;
-
-/**
- * @brief Funzione che esegue una serie di operazioni base diverse istanze di classi.
- * 
- * La funzione crea diverse istanze di classi bst_int, bst_char e team,
- * e esegue una serie di operazioni su di esse.
- */
-void metodi_fondamentali()
-{
-    bst_int b;
-    std::cout << b << std::endl;
-    b.add(5);
-    b.add(8);
-    std::cout << b << std::endl;
-    b.add(9);
-    std::cout << b << std::endl;
-    b.add(10);
-    b.add(12);
-    std::cout << b << std::endl;
-    b.add(11);
-    std::cout << b << std::endl;
-
-    bst_int bi(b);
-    std::cout << bi << std::endl;
-    bst_int bi2;
-    bi2 = bi;
-    std::cout << bi2 << std::endl;
-
-
-    bst_char bc('b');
-    std::cout << bc << std::endl;
-    bc.add('c');
-    bc.add('a');
-    std::cout << bc << std::endl;
-    bst_char bc1(bc);
-    std::cout << bc1 << std::endl;
-    bst_char bc2;
-    bc2 = bc;
-    std::cout << bc2 << std::endl;
-
-    team t1("Atalanta", 4);
-    team t2("Inter", 1);
-    team t3("Roma", 6);
-    team t4("Milan", 2);
-    bst<team, compare_team, equal_team> bt;
-    bt.add(t1);
-    bt.add(t2);
-    bt.add(t3);
-    bt.add(t4);
-    std::cout << bt << std::endl;
-    bst<team, compare_team, equal_team> bt1(bt);
-    std::cout << bt1 << std::endl;
-    bst<team, compare_team, equal_team> bt2;
-    bt2 = bt;
-    std::cout << bt2 << std::endl;
-}
-
-/**
- * @brief Funzione che esegue una serie di operazioni avanzate utilizzando diverse istanze di classi.
- * 
- * La funzione crea diverse istanze di classi bst_int, bst_char e team,
- * e esegue una serie di operazioni avanzate su di esse.
- */
-void utilizzo()
-{
-    int arr[5] = {5, 4, 3, 2, 1};
-    bst_int bi(arr, arr + 5);
-    std::cout << "Size: " << bi.size() << std::endl;
-    std::cout << bi << std::endl;
-    std::cout << "Find 3: " << bi.find(3) << std::endl;
-    std::cout << "Find 6: " << bi.find(6) << std::endl;
-
-    char carr[5] = {'e', 'd', 'c', 'b', 'a'};
-    bst_char bci(carr, carr + 5);
-    std::cout << bci << std::endl;
-    std::cout << "Size: " << bci.size() << std::endl;
-    std::cout << "Find 'c': " << bci.find('c') << std::endl;
-    std::cout << "Find 'f': " << bci.find('f') << std::endl;
-    std::cout << "Find 0: " << bci.find(0) << std::endl;
-
-    team t1("Juventus", 3);
-    team t2("Inter", 1);
-    team tarr[2] = {team("Bologna", 5), team("Milan", 2)};
-    bst<team, compare_team, equal_team> bt(tarr, tarr + 2);
-    std::cout << bt << std::endl;
-    bt.add(t1);
-    std::cout << "Size: " << bt.size() << std::endl;
-    std::cout << "Find Juventus: " << bt.find(t1) << std::endl;
-    std::cout << "Find Inter: " << bt.find(team("Inter", 1)) << std::endl;
-    std::cout << "Find Inter: " << bt.find(t2) << std::endl;
-    // std::cout << "Find Bologna: " << bt.find("Bologna") << std::endl;
-    // Errore perchè find cerca nell'albero
-    // il value del nodo, in questo caso il value è team non name
-}
-
-/**
- * @brief Funzione che esegue una serie di operazioni tramite gli iteratori
- * 
- * La funzione crea diverse istanze di classi bst_int, bst_char e team,
- * e esegue una serie di operazioni sugli iteratori delle classi.
- */
-void iteratori()
-{
-    int arr[7] = {57, 22, 77, 11, 42, 65, 90};
-    bst_int bi(arr, arr + 7);
-    std::cout << bi << std::endl;
-    bst_int::const_iterator i, ie;
-    for (i = bi.begin(), ie = bi.end(); i != ie; i++)
-    {
-        std::cout << *i << std::endl;
-    }
-
-    char carr[7] = {'e', 'd', 'c', 'b', 'a', 'f', 'g'};
-    const bst_char bci(carr, carr + 7);
-    std::cout << bci << std::endl;
-    bst_char::const_iterator ci, ce;
-    for (ci = bci.begin(), ce = bci.end(); ci != ce; ci++)
-    {
-        std::cout << *ci << std::endl;
-    }
-
-    team tarr[4] = {team("Juventus", 3), team("Inter", 1), team("Milan", 2), team("Roma", 6)};
-    const bst<team, compare_team, equal_team> bt(tarr, tarr + 4);
-    std::cout << bt << std::endl;
-    bst<team, compare_team, equal_team>::const_iterator ti, te;
-    for (ti = bt.begin(), te = bt.end(); ti != te; ti++)
-    {
-        std::cout << *ti << std::endl;
-    }
-}
-
-/**
- * @brief Funzione che esegue una serie di operazioni di creazione di sottoalberi
- * 
- * La funzione crea diverse istanze di classi bst_int, bst_char e team,
- * e crea dei sottoalberi a partire da un nodo specifico.
- */
-void subtree()
-{
-    int arr[7] = {57, 22, 77, 11, 42, 65, 90};
-    bst_int bi(arr, arr + 7);
-    std::cout << bi << std::endl;
-    bst_int bi1 = bi.subtree(57);
-    std::cout << bi1 << std::endl;
-    bst_int bi2 = bi.subtree(22);
-    std::cout << bi2 << std::endl;
-    bst_int bi3 = bi.subtree(90);
-    std::cout << bi3 << std::endl;
-    bst_int bi4 = bi.subtree(104);
-    std::cout << bi4 << std::endl;
-
-    char carr[7] = {'e', 'd', 'c', 'b', 'a', 'f', 'g'};
-    bst_char bci(carr, carr + 7);
-    std::cout << bci << std::endl;
-    bst_char bci1 = bci.subtree('e');
-    std::cout << bci1 << std::endl;
-    bst_char bci2 = bci.subtree('d');
-    std::cout << bci2 << std::endl;
-    bst_char bci3 = bci.subtree('g');
-    std::cout << bci3 << std::endl;
-    bst_char bci4 = bci.subtree('z');
-    std::cout << bci4 << std::endl;
-
-    team tarr[4] = {team("Juventus", 3), team("Inter", 1), team("Milan", 2), team("Roma", 6)};
-    bst<team, compare_team, equal_team> bt(tarr, tarr + 4);
-    std::cout << bt << std::endl;
-    bst<team, compare_team, equal_team> bt1 = bt.subtree(team("Juventus", 3));
-    std::cout << bt1 << std::endl;
-    bst<team, compare_team, equal_team> bt2 = bt.subtree(team("Inter", 1));
-    std::cout << bt2 << std::endl;
-    bst<team, compare_team, equal_team> bt3 = bt.subtree(team("Roma", 6));
-    std::cout << bt3 << std::endl;
-    bst<team, compare_team, equal_team> bt4 = bt.subtree(team("Napoli", 5));
-    std::cout << bt4 << std::endl;
-    bst<team, compare_team, equal_team> bt5 = bt.subtree(team(
-}
-
-/**
- * @brief Funtore di numeri interi pari
- * 
- * Valuta se un numero intero è pari.
- */
-struct is_even
-{
-    bool operator()(int a) const
-    {
-        return a % 2 == 0;
-    }
-};
-
-/**
- * @brief Funtore di numeri interi maggiori di 50
- * 
- * Valuta se un numero intero è maggiore di 50.
- */
-struct grt50
-{
-    bool operator()(int a) const
-    {
-        return a > 50;
-    }
-};
-
-/**
- * @brief Funtore di vocali
- * 
- * Valuta se un carattere è una vocale.
- */
-struct is_vowel
-{
-    bool operator()(char a) const
-    {
-        return a == 'a' || a == 'e' || a == 'i' || a == 'o' || a == 'u';
-    }
-};
-
-/**
- * Funzione che stampa le squadre che andranno in champions league in base alla loro posizione.
- */
-struct cmpl
-{
-    bool operator()(team a) const
-    {
-        return a.position < 5;
-    }
-};
-
-/**
- * Funzione che stampa gli elementi dell'albero che soddisfano il predicato P.
- */
-void printif()
-{
-    int arr[7] = {57, 22, 77, 11, 42, 65, 90};
-    bst_int bi(arr, arr + 7);
-    std::cout << bi << std::endl;
-    std::cout << "Even numbers:" << std::endl;
-    printIF(bi, is_even());
-    std::cout << "Greater than 50:" << std::endl;
-    printIF(bi, grt50());
-
-    char carr[7] = {'e', 'd', 'c', 'b', 'a', 'f', 'g'};
-    bst_char bci(carr, carr + 7);
-    std::cout << bci << std::endl;
-    std::cout << "Vowels:" << std::endl;
-    printIF(bci, is_vowel());
-
-    team tarr[4] = {team("Juventus", 3), team("Inter", 1), team("Milan", 2), team("Roma", 6)};
-    bst<team, compare_team, equal_team> bt(tarr, tarr + 4);
-    std::cout << bt << std::endl;
-    std::cout << "Club in champions league:" << std::endl;
-    printIF(bt, cmpl());
-}
-
-int main(int argc, char *argv[])
-{
-    metodi_fondamentali();
-
-    utilizzo();
-
-    iteratori();
-
-    subtree();
-
-    printif();
-
-    return 0;
+/**
+ * @file main.cpp
+ * 
+ * @brief Test d'uso della classe bst templata
+ */
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <vector>
+#include <atomic>
+#include <memory_resource>
+
+#include "bst.hpp"
+#include "persistent_bst.hpp"
+#include "compact_bst.hpp"
+#include "small_bst.hpp"
+
+/**
+ * @brief Funtore di ordinamento tra tipi interi
+ * 
+ * Ordina due interi in ordine crescente.
+ */
+struct compare_int
+{
+    bool operator()(int a, int b) const
+    {
+        return a < b;
+    }
+};
+
+/**
+ * @brief Funtore di uguaglianza tra tipi interi
+ * 
+ * Valuta l'uglianza tra due interi.
+ */
+struct equal_int
+{
+    bool operator()(int a, int b) const
+    {
+        return a == b;
+    }
+};
+
+/**
+ * @brief Funtore di ordinamento tra tipi char
+ * 
+ * Ordina due char in ordine crescente.
+ */
+struct compare_char
+{
+    bool operator()(char a, char b) const
+    {
+        return a < b;
+    }
+};
+
+/**
+ * @brief Funtore di uguaglianza tra tipi char
+ * 
+ * Valuta l'uglianza tra due char.
+ */
+struct equal_char
+{
+    bool operator()(char a, char b) const
+    {
+        return a == b;
+    }
+};
+
+/**
+ * @brief Funtore di ordinamento tra tipi team
+ * 
+ * Ordina due team in ordine crescente.
+ */
+struct team
+{
+    std::string name;
+    int position;
+
+    team(std::string n, int p) : name(n), position(p) {}
+};
+
+/**
+ * @brief Funtore di ordinamento tra tipi team
+ * 
+ * Ordina due team in ordine crescente.
+ * È trasparente: accetta anche la sola posizione come chiave di ricerca.
+ */
+struct compare_team
+{
+    typedef void is_transparent;
+
+    bool operator()(const team &a, const team &b) const
+    {
+        return a.position < b.position;
+    }
+
+    bool operator()(int a, const team &b) const
+    {
+        return a < b.position;
+    }
+
+    bool operator()(const team &a, int b) const
+    {
+        return a.position < b;
+    }
+};
+
+/**
+ * @brief Funtore di uguaglianza tra tipi team
+ * 
+ * Valuta l'uglianza tra due team, o tra una posizione e un team.
+ */
+struct equal_team
+{
+    bool operator()(const team &a, const team &b) const
+    {
+        return a.position == b.position;
+    }
+
+    bool operator()(int a, const team &b) const
+    {
+        return a == b.position;
+    }
+
+    bool operator()(const team &a, int b) const
+    {
+        return a.position == b;
+    }
+};
+
+/**
+ * @brief Operatore di output per team
+ * 
+ * Stampa il nome e la posizione della squadra.
+ */
+std::ostream &operator<<(std::ostream &os, const team &t)
+{
+    std::cout << t.position << ") " << t.name;
+    return os;
+}
+
+
+// typedef della classe su interi di comodo
+typedef bst<int, compare_int, equal_int> bst_int;
+
+// typedef della classe su char di comodo
+typedef bst<char, compare_char, equal_char> bst_char;
+
+// typedef della classe bilanciata AVL su interi di comodo
+typedef bst<int, compare_int, equal_int, bst_avl> bst_int_avl;
+
+/**
+ * @brief Funzione che esegue una serie di operazioni base diverse istanze di classi.
+ * 
+ * La funzione crea diverse istanze di classi bst_int, bst_char e team,
+ * e esegue una serie di operazioni su di esse.
+ */
+void metodi_fondamentali()
+{
+    bst_int b;
+    std::cout << b << std::endl;
+    b.add(5);
+    b.add(8);
+    std::cout << b << std::endl;
+    b.add(9);
+    std::cout << b << std::endl;
+    b.add(10);
+    b.add(12);
+    std::cout << b << std::endl;
+    b.add(11);
+    std::cout << b << std::endl;
+
+    bst_int bi(b);
+    std::cout << bi << std::endl;
+    bst_int bi2;
+    bi2 = bi;
+    std::cout << bi2 << std::endl;
+
+
+    bst_char bc('b');
+    std::cout << bc << std::endl;
+    bc.add('c');
+    bc.add('a');
+    std::cout << bc << std::endl;
+    bst_char bc1(bc);
+    std::cout << bc1 << std::endl;
+    bst_char bc2;
+    bc2 = bc;
+    std::cout << bc2 << std::endl;
+
+    team t1("Atalanta", 4);
+    team t2("Inter", 1);
+    team t3("Roma", 6);
+    team t4("Milan", 2);
+    bst<team, compare_team, equal_team> bt;
+    bt.add(t1);
+    bt.add(t2);
+    bt.add(t3);
+    bt.add(t4);
+    std::cout << bt << std::endl;
+    bt.emplace("Lazio", 7);
+    bt.add(team("Napoli", 5));
+    std::cout << bt << std::endl;
+    bst<team, compare_team, equal_team> bt1(bt);
+    std::cout << bt1 << std::endl;
+    bst<team, compare_team, equal_team> bt2;
+    bt2 = bt;
+    std::cout << bt2 << std::endl;
+    bst<team, compare_team, equal_team> bt3(std::move(bt2));
+    std::cout << "Size: " << bt3.size() << " " << bt2.size() << std::endl;
+}
+
+/**
+ * @brief Funzione che esegue una serie di operazioni avanzate utilizzando diverse istanze di classi.
+ * 
+ * La funzione crea diverse istanze di classi bst_int, bst_char e team,
+ * e esegue una serie di operazioni avanzate su di esse.
+ */
+void utilizzo()
+{
+    int arr[5] = {5, 4, 3, 2, 1};
+    bst_int bi(arr, arr + 5);
+    std::cout << "Size: " << bi.size() << std::endl;
+    std::cout << bi << std::endl;
+    std::cout << "Find 3: " << bi.find(3) << std::endl;
+    std::cout << "Find 6: " << bi.find(6) << std::endl;
+
+    char carr[5] = {'e', 'd', 'c', 'b', 'a'};
+    bst_char bci(carr, carr + 5);
+    std::cout << bci << std::endl;
+    std::cout << "Size: " << bci.size() << std::endl;
+    std::cout << "Find 'c': " << bci.find('c') << std::endl;
+    std::cout << "Find 'f': " << bci.find('f') << std::endl;
+    std::cout << "Find 0: " << bci.find(0) << std::endl;
+
+    team t1("Juventus", 3);
+    team t2("Inter", 1);
+    team tarr[2] = {team("Bologna", 5), team("Milan", 2)};
+    bst<team, compare_team, equal_team> bt(tarr, tarr + 2);
+    std::cout << bt << std::endl;
+    bt.add(t1);
+    std::cout << "Size: " << bt.size() << std::endl;
+    std::cout << "Find Juventus: " << bt.find(t1) << std::endl;
+    std::cout << "Find Inter: " << bt.find(team("Inter", 1)) << std::endl;
+    std::cout << "Find Inter: " << bt.find(t2) << std::endl;
+    std::cout << "Find position 5: " << bt.find(5) << std::endl;
+    std::cout << "Find position 4: " << bt.find(4) << std::endl;
+    // std::cout << "Find Bologna: " << bt.find("Bologna") << std::endl;
+    // Errore perchè find cerca nell'albero
+    // il value del nodo, in questo caso il value è team non name
+}
+
+/**
+ * @brief Funzione che esegue una serie di operazioni tramite gli iteratori
+ * 
+ * La funzione crea diverse istanze di classi bst_int, bst_char e team,
+ * e esegue una serie di operazioni sugli iteratori delle classi.
+ */
+void iteratori()
+{
+    int arr[7] = {57, 22, 77, 11, 42, 65, 90};
+    bst_int bi(arr, arr + 7);
+    std::cout << bi << std::endl;
+    bst_int::const_iterator i, ie;
+    for (i = bi.begin(), ie = bi.end(); i != ie; i++)
+    {
+        std::cout << *i << std::endl;
+    }
+
+    char carr[7] = {'e', 'd', 'c', 'b', 'a', 'f', 'g'};
+    const bst_char bci(carr, carr + 7);
+    std::cout << bci << std::endl;
+    bst_char::const_iterator ci, ce;
+    for (ci = bci.begin(), ce = bci.end(); ci != ce; ci++)
+    {
+        std::cout << *ci << std::endl;
+    }
+
+    team tarr[4] = {team("Juventus", 3), team("Inter", 1), team("Milan", 2), team("Roma", 6)};
+    const bst<team, compare_team, equal_team> bt(tarr, tarr + 4);
+    std::cout << bt << std::endl;
+    bst<team, compare_team, equal_team>::const_iterator ti, te;
+    for (ti = bt.begin(), te = bt.end(); ti != te; ti++)
+    {
+        std::cout << *ti << std::endl;
+    }
+
+    // visita all'indietro: le prime tre squadre partendo dal fondo della classifica
+    std::cout << "Last three:" << std::endl;
+    bst<team, compare_team, equal_team>::const_reverse_iterator ri = bt.rbegin();
+    for (int k = 0; k < 3 && ri != bt.rend(); ++k, ++ri)
+    {
+        std::cout << *ri << std::endl;
+    }
+
+    // albero con i nodi collegati in ordine: ++ e -- seguono un solo puntatore
+    bst<int, compare_int, equal_int, bst_avl, bst_threaded> bth(arr, arr + 7);
+    std::cout << "Descending:";
+    for (bst<int, compare_int, equal_int, bst_avl, bst_threaded>::const_iterator d = bth.end(); d != bth.begin();)
+    {
+        std::cout << ' ' << *--d;
+    }
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Funzione che esegue una serie di operazioni di creazione di sottoalberi
+ * 
+ * La funzione crea diverse istanze di classi bst_int, bst_char e team,
+ * e crea dei sottoalberi a partire da un nodo specifico.
+ */
+void subtree()
+{
+    int arr[7] = {57, 22, 77, 11, 42, 65, 90};
+    bst_int bi(arr, arr + 7);
+    std::cout << bi << std::endl;
+    bst_int bi1 = bi.subtree(57);
+    std::cout << bi1 << std::endl;
+    bst_int bi2 = bi.subtree(22);
+    std::cout << bi2 << std::endl;
+    bst_int bi3 = bi.subtree(90);
+    std::cout << bi3 << std::endl;
+    bst_int bi4 = bi.subtree(104);
+    std::cout << bi4 << std::endl;
+    bst_int::subtree_view vi = bi.view(22);
+    std::cout << vi << std::endl;
+    std::cout << "Size: " << vi.size() << std::endl;
+    std::cout << "Find 42: " << vi.find(42) << std::endl;
+    std::cout << "Find 77: " << vi.find(77) << std::endl;
+
+    char carr[7] = {'e', 'd', 'c', 'b', 'a', 'f', 'g'};
+    bst_char bci(carr, carr + 7);
+    std::cout << bci << std::endl;
+    bst_char bci1 = bci.subtree('e');
+    std::cout << bci1 << std::endl;
+    bst_char bci2 = bci.subtree('d');
+    std::cout << bci2 << std::endl;
+    bst_char bci3 = bci.subtree('g');
+    std::cout << bci3 << std::endl;
+    bst_char bci4 = bci.subtree('z');
+    std::cout << bci4 << std::endl;
+
+    team tarr[4] = {team("Juventus", 3), team("Inter", 1), team("Milan", 2), team("Roma", 6)};
+    bst<team, compare_team, equal_team> bt(tarr, tarr + 4);
+    std::cout << bt << std::endl;
+    bst<team, compare_team, equal_team> bt1 = bt.subtree(team("Juventus", 3));
+    std::cout << bt1 << std::endl;
+    bst<team, compare_team, equal_team> bt2 = bt.subtree(team("Inter", 1));
+    std::cout << bt2 << std::endl;
+    bst<team, compare_team, equal_team> bt3 = bt.subtree(team("Roma", 6));
+    std::cout << bt3 << std::endl;
+    bst<team, compare_team, equal_team> bt3p = bt.subtree(1);
+    std::cout << bt3p << std::endl;
+    bst<team, compare_team, equal_team> bt4 = bt.subtree(team("Napoli", 5));
+    std::cout << bt4 << std::endl;
+    bst<team, compare_team, equal_team> bt5 = bt.subtree(team("Milan", 2));
+    std::cout << bt5 << std::endl;
+}
+
+/**
+ * @brief Funtore di numeri interi pari
+ * 
+ * Valuta se un numero intero è pari.
+ */
+struct is_even
+{
+    bool operator()(int a) const
+    {
+        return a % 2 == 0;
+    }
+};
+
+/**
+ * @brief Funtore di numeri interi maggiori di 50
+ * 
+ * Valuta se un numero intero è maggiore di 50.
+ */
+struct grt50
+{
+    bool operator()(int a) const
+    {
+        return a > 50;
+    }
+};
+
+/**
+ * @brief Funtore di vocali
+ * 
+ * Valuta se un carattere è una vocale.
+ */
+struct is_vowel
+{
+    bool operator()(char a) const
+    {
+        return a == 'a' || a == 'e' || a == 'i' || a == 'o' || a == 'u';
+    }
+};
+
+/**
+ * Funzione che stampa le squadre che andranno in champions league in base alla loro posizione.
+ */
+struct cmpl
+{
+    bool operator()(const team &a) const
+    {
+        return a.position < 5;
+    }
+};
+
+/**
+ * Funzione che stampa gli elementi dell'albero che soddisfano il predicato P.
+ */
+void printif()
+{
+    int arr[7] = {57, 22, 77, 11, 42, 65, 90};
+    bst_int bi(arr, arr + 7);
+    std::cout << bi << std::endl;
+    std::cout << "Even numbers:" << std::endl;
+    printIF(bi, is_even());
+    std::cout << "Greater than 50:" << std::endl;
+    printIF(bi, grt50());
+    std::cout << "Even numbers under 22:" << std::endl;
+    printIF(bi.view(22), is_even());
+
+    char carr[7] = {'e', 'd', 'c', 'b', 'a', 'f', 'g'};
+    bst_char bci(carr, carr + 7);
+    std::cout << bci << std::endl;
+    std::cout << "Vowels:" << std::endl;
+    printIF(bci, is_vowel());
+
+    team tarr[4] = {team("Juventus", 3), team("Inter", 1), team("Milan", 2), team("Roma", 6)};
+    bst<team, compare_team, equal_team> bt(tarr, tarr + 4);
+    std::cout << bt << std::endl;
+    std::cout << "Club in champions league:" << std::endl;
+    printIF(bt, cmpl());
+}
+
+/**
+ * @brief Funzione che confronta un albero non bilanciato con uno bilanciato AVL
+ *
+ * Inserisce chiavi ordinate una alla volta nell'albero non bilanciato, che degenera in una lista,
+ * e le carica in blocco (già bilanciate) oppure in un albero AVL.
+ */
+void bilanciamento()
+{
+    int arr[7] = {1, 2, 3, 4, 5, 6, 7};
+    bst_int bi;
+    for (int i = 0; i < 7; ++i)
+        bi.add(arr[i]);
+    std::cout << bi << std::endl;
+    bst_int bi1 = bi.subtree(4);
+    std::cout << bi1 << std::endl;
+
+    bst_int bs(bst_from_sorted, arr, arr + 7);
+    bst_int bs1 = bs.subtree(2);
+    std::cout << bs1 << std::endl;
+
+    bst_int_avl ba(arr, arr + 7);
+    std::cout << ba << std::endl;
+    bst_int_avl ba1 = ba.subtree(2);
+    std::cout << ba1 << std::endl;
+    bst_int_avl ba2 = ba.subtree(4);
+    std::cout << "Size: " << ba2.size() << std::endl;
+    std::cout << "Find 6: " << ba.find(6) << std::endl;
+    std::cout << "Even numbers:" << std::endl;
+    printIF(ba, is_even());
+
+    frozen_bst<int, compare_int, equal_int> fa = ba.freeze();
+    std::cout << fa << std::endl;
+    std::cout << "Find 6: " << fa.find(6) << std::endl;
+    std::cout << "Find 8: " << fa.find(8) << std::endl;
+    std::cout << "Even numbers:" << std::endl;
+    printIF(fa, is_even());
+}
+
+/**
+ * @brief Funzione che esegue rimozioni e interrogazioni per intervallo
+ *
+ * La funzione rimuove elementi per valore e tramite iteratore,
+ * e stampa gli elementi compresi in un intervallo partendo da lower_bound.
+ */
+void rimozione()
+{
+    int arr[7] = {57, 22, 77, 11, 42, 65, 90};
+    bst_int bi(arr, arr + 7);
+    std::cout << bi << std::endl;
+    std::cout << "Erase 22: " << bi.erase(22) << std::endl;
+    std::cout << "Erase 23: " << bi.erase(23) << std::endl;
+    std::cout << bi << std::endl;
+    bst_int::const_iterator i = bi.erase(bi.lower_bound(57));
+    std::cout << "After 57: " << *i << std::endl;
+    std::cout << bi << std::endl;
+
+    std::cout << "Range [40, 80):" << std::endl;
+    for (i = bi.lower_bound(40); i != bi.lower_bound(80); ++i)
+    {
+        std::cout << *i << std::endl;
+    }
+
+    team tarr[4] = {team("Juventus", 3), team("Inter", 1), team("Milan", 2), team("Roma", 6)};
+    bst<team, compare_team, equal_team> bt(tarr, tarr + 4);
+    bt.erase(2);
+    std::cout << bt << std::endl;
+    std::cout << "First after position 1: " << *bt.upper_bound(1) << std::endl;
+}
+
+/**
+ * @brief Funzione che interroga una classifica tramite statistiche d'ordine
+ *
+ * La funzione usa un albero AVL con i conteggi dei sottoalberi per calcolare
+ * la mediana, la posizione di una squadra e il numero di squadre in un intervallo.
+ */
+void statistiche()
+{
+    team tarr[6] = {team("Juventus", 3), team("Inter", 1), team("Milan", 2),
+                    team("Roma", 6), team("Bologna", 5), team("Atalanta", 4)};
+    bst<team, compare_team, equal_team, bst_avl, bst_order_statistics> bt(tarr, tarr + 6);
+    std::cout << bt << std::endl;
+    std::cout << "Median: " << *bt.select(bt.size() / 2) << std::endl;
+    std::cout << "Teams above position 4: " << bt.rank(4) << std::endl;
+    std::cout << "Teams in [2, 5): " << bt.count_range(team("", 2), team("", 5)) << std::endl;
+}
+
+/**
+ * @brief Funzione che costruisce e visita un albero con più thread
+ *
+ * La funzione costruisce un albero da una sequenza disordinata con la costruzione
+ * parallela, poi conta i valori pari e ne calcola la somma con più thread.
+ */
+void parallelo()
+{
+    std::vector<int> v;
+    for (int i = 0; i < 100000; ++i)
+    {
+        v.push_back((i * 7919) % 100000);
+    }
+    bst_int_avl bi(bst_parallel, v.begin(), v.end(), 4);
+    std::cout << "Size: " << bi.size() << std::endl;
+
+    std::atomic<int> even(0);
+    bi.parallel_for_each_if(is_even(), [&even](int)
+                            { ++even; });
+    std::cout << "Even values: " << even << std::endl;
+
+    long long sum = bi.parallel_reduce(0LL, [](int x)
+                                       { return (long long)x; },
+                                       [](long long a, long long b)
+                                       { return a + b; });
+    std::cout << "Sum: " << sum << std::endl;
+}
+
+/**
+ * @brief Funzione che combina alberi con le operazioni insiemistiche
+ *
+ * La funzione divide un albero in due parti, le riunisce e calcola unione,
+ * intersezione e differenza con un altro albero.
+ */
+void insiemi()
+{
+    int arr1[7] = {57, 22, 77, 11, 42, 65, 90};
+    int arr2[5] = {22, 30, 65, 90, 100};
+    bst_int_avl b1(arr1, arr1 + 7);
+    bst_int_avl b2(arr2, arr2 + 5);
+
+    bst_int_avl high = b1.split(50);
+    std::cout << "Below 50: " << b1 << std::endl;
+    std::cout << "From 50: " << high << std::endl;
+    b1.join(std::move(high));
+    std::cout << "Joined: " << b1 << std::endl;
+
+    bst_int_avl u(b1), i(b1), d(b1);
+    u.set_union(b2);
+    i.set_intersection(b2);
+    d.set_difference(b2);
+    std::cout << "Union: " << u << std::endl;
+    std::cout << "Intersection: " << i << std::endl;
+    std::cout << "Difference: " << d << std::endl;
+}
+
+/**
+ * @brief Funzione che pubblica istantanee di un albero persistente
+ *
+ * La funzione modifica un albero dopo averne preso un'istantanea
+ * e mostra che l'istantanea non vede le modifiche.
+ */
+void persistenza()
+{
+    persistent_bst<int, compare_int, equal_int> pb;
+    for (int i = 1; i <= 5; ++i)
+    {
+        pb.add(i * 15);
+    }
+    persistent_bst<int, compare_int, equal_int> snap = pb.snapshot();
+    pb.add(25);
+    pb.erase(45);
+    std::cout << "Current: " << pb << std::endl;
+    std::cout << "Snapshot: " << snap << std::endl;
+    printIF(snap, grt50());
+}
+
+/**
+ * @brief Funzione che salva un albero su file e lo riapre mappandolo in memoria
+ *
+ * La funzione scrive l'albero in formato binario, lo riapre in sola lettura
+ * senza ricostruire i nodi e cerca alcuni valori nell'indice ottenuto.
+ */
+void serializzazione()
+{
+    int arr[7] = {57, 22, 77, 11, 42, 65, 90};
+    bst_int bi(arr, arr + 7);
+    {
+        std::ofstream out("bst_int.bin", std::ios::binary);
+        bi.save(out);
+    }
+
+    frozen_bst<int, compare_int, equal_int> fi = frozen_bst<int, compare_int, equal_int>::map("bst_int.bin");
+    std::cout << "Mapped: " << fi << std::endl;
+    std::cout << "Find 42: " << fi.find(42) << std::endl;
+    std::cout << "Find 43: " << fi.find(43) << std::endl;
+    std::remove("bst_int.bin");
+}
+
+/**
+ * Funzione che filtra gli elementi dell'albero senza copiarli e li scrive su uno stream qualsiasi.
+ */
+void filtri()
+{
+    int arr[7] = {57, 22, 77, 11, 42, 65, 90};
+    bst_int bi(arr, arr + 7);
+
+    std::cout << "Even numbers (lazy view):";
+    for (int v : bi.filter(is_even()))
+        std::cout << ' ' << v;
+    std::cout << std::endl;
+
+    int sum = 0;
+    bi.for_each_if(grt50(), [&sum](int v)
+                   { sum += v; });
+    std::cout << "Sum of values greater than 50: " << sum << std::endl;
+
+    std::ostringstream out;
+    bi.write_if(out, grt50(), ',');
+    std::cout << "Greater than 50 (to a string stream): " << out.str() << std::endl;
+}
+
+/**
+ * @brief Funzione che misura la forma di un albero con la policy di strumentazione
+ *
+ * Le stesse chiavi ordinate vengono inserite in un albero non bilanciato e in uno AVL:
+ * i contatori mostrano quanti confronti e quanto lunghe sono le discese nei due casi.
+ * Un terzo albero ricava l'uguaglianza dal confronto e scende con un confronto per livello.
+ */
+void strumentazione()
+{
+    bst<int, compare_int, equal_int, bst_unbalanced, bst_no_augment, bst_counting_stats> bu;
+    bst<int, compare_int, equal_int, bst_avl, bst_no_augment, bst_counting_stats> ba;
+    for (int i = 0; i < 1000; ++i)
+    {
+        bu.add(i);
+        ba.add(i);
+    }
+    std::cout << "Unbalanced: " << bu.stats() << std::endl;
+    std::cout << "AVL: " << ba.stats() << std::endl;
+
+    ba.reset_stats();
+    ba.find(500);
+    std::cout << "AVL find(500) visited " << ba.stats().last_path << " nodes with "
+              << ba.stats().comparisons << " comparisons" << std::endl;
+
+    // uguaglianza ricavata da compare_int: un solo confronto per livello
+    bst<int, compare_int, bst_equivalent<compare_int>, bst_avl, bst_no_augment, bst_counting_stats> bd;
+    for (int i = 0; i < 1000; ++i)
+        bd.add(i);
+    bd.reset_stats();
+    bd.find(500);
+    std::cout << "Derived equality find(500) visited " << bd.stats().last_path << " nodes with "
+              << bd.stats().comparisons << " comparisons" << std::endl;
+}
+
+/**
+ * @brief Funzione che confronta l'occupazione di memoria di un albero compatto
+ *
+ * Un milione di interi viene caricato in un `compact_bst` AVL, con i nodi in un unico
+ * vettore e indici a 32 bit; la memoria usata viene confrontata con quella stimata
+ * per gli stessi nodi in un `bst`.
+ */
+void compatto()
+{
+    std::vector<int> v;
+    for (int i = 0; i < 1000000; ++i)
+        v.push_back(i * 2);
+
+    compact_bst<int, compare_int, equal_int, bst_avl> ci(bst_from_sorted, v.begin(), v.end());
+    std::cout << "Compact memory: " << ci.memory() / 1024 << " KB" << std::endl;
+    std::cout << "bst memory: at least " << ci.size() * (sizeof(int) + 3 * sizeof(void *)) / 1024 << " KB" << std::endl;
+
+    ci.add(7);
+    ci.erase(10);
+    std::cout << "Compact size: " << ci.size() << ", find 7: " << ci.find(7) << ", find 10: " << ci.find(10) << std::endl;
+
+    compact_bst<int, compare_int, equal_int> small(v.begin(), v.begin() + 10);
+    std::cout << "Compact: " << small << std::endl;
+}
+
+/**
+ * @brief Funzione che usa un albero piccolo, tenuto nell'oggetto senza allocazioni
+ *
+ * Le prime quattro squadre stanno nell'array interno; la quinta fa passare
+ * i valori in un `bst`, senza che cambino iterazione, ricerca e sottoalberi.
+ */
+void piccoli()
+{
+    small_bst<team, compare_team, equal_team, 4> st;
+    st.add(team("Inter", 3));
+    st.add(team("Milan", 1));
+    st.add(team("Roma", 5));
+    st.add(team("Napoli", 2));
+    std::cout << "Inline: " << st.is_inline() << ", find 2: " << st.find(2) << std::endl;
+    std::cout << "Subtree of 1: " << st.subtree(team("Milan", 1)) << std::endl;
+
+    st.add(team("Lazio", 4));
+    std::cout << "Inline: " << st.is_inline() << ", find 4: " << st.find(4) << std::endl;
+    printIF(st, [](const team &t)
+            { return t.position % 2 == 1; });
+}
+
+/**
+ * @brief Funzione che costruisce e distrugge un albero dentro un buffer sullo stack
+ *
+ * I nodi di un `pmr_bst` vengono presi da una `std::pmr::monotonic_buffer_resource`:
+ * con `null_memory_resource` come riserva, qualunque allocazione oltre il buffer fallirebbe.
+ */
+void allocatori()
+{
+    alignas(std::max_align_t) char buffer[16384];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+    pmr_bst<int, compare_int, equal_int, bst_avl> ba(&arena);
+    for (int i = 0; i < 100; ++i)
+        ba.add((i * 37) % 100);
+    std::cout << "Arena size: " << ba.size() << ", find 42: " << ba.find(42) << std::endl;
+    std::cout << "Arena subtree of 50: " << ba.subtree(50).size() << " values" << std::endl;
+}
+
+/**
+ * @brief Funzione che mostra un albero autoaggiustante con ricerche sbilanciate
+ *
+ * Con la policy `bst_splay<4>` una chiave sale alla radice al quarto accesso: l'inserimento
+ * conta come il primo, quindi basta cercarla tre volte. Le ricerche successive visitano un solo
+ * nodo, mentre un `find` costante non cambia la forma.
+ */
+void autoaggiustante()
+{
+    bst<int, compare_int, equal_int, bst_splay<4>, bst_no_augment, bst_counting_stats> bs;
+    for (int i = 0; i < 1000; ++i)
+        bs.add((i * 7919) % 1000);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        bs.find(123);
+        std::cout << "Find 123 visited " << bs.stats().last_path << " nodes" << std::endl;
+    }
+    bs.find(123);
+    std::cout << "Find 123 visited " << bs.stats().last_path << " nodes" << std::endl;
+
+    const auto &cbs = bs;
+    cbs.find(500);
+    std::cout << "Const find 500, root still 123: " << bs.find(123) << " (" << bs.stats().last_path << " node)" << std::endl;
+}
+
+int main()
+{
+    metodi_fondamentali();
+
+    utilizzo();
+
+    iteratori();
+
+    subtree();
+
+    printif();
+
+    bilanciamento();
+
+    rimozione();
+
+    statistiche();
+
+    parallelo();
+
+    insiemi();
+
+    persistenza();
+
+    serializzazione();
+
+    filtri();
+
+    strumentazione();
+
+    compatto();
+
+    piccoli();
+
+    allocatori();
+
+    autoaggiustante();
+
+    return 0;
 }
\ No newline at end of file
@@ -0,0 +1,741 @@
+#ifndef PERSISTENT_BST_HPP
+#define PERSISTENT_BST_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "bst.hpp"
+
+/**
+ * @brief Albero binario di ricerca persistente, con copie in O(1).
+ *
+ * I nodi sono immutabili e condivisi tra tutte le versioni dell'albero tramite un
+ * contatore di riferimenti atomico. Copiare l'albero (o chiamare `snapshot()`) copia
+ * solo il puntatore alla radice; `add` ed `erase` non modificano alcun nodo esistente
+ * ma ricreano il solo cammino dalla radice al punto modificato (path copying), cioè
+ * O(log n) nodi nuovi, perché l'albero è bilanciato con la regola AVL.
+ *
+ * Una copia può essere letta da altri thread mentre l'originale continua a essere
+ * modificato; uno stesso oggetto invece non può essere modificato da più thread insieme.
+ *
+ * @tparam T Il tipo di valore contenuto nei nodi dell'albero.
+ * @tparam Comp Il tipo di funzione di confronto per ordinare i nodi.
+ * @tparam Equal Il tipo di funzione di uguaglianza per confrontare i valori dei nodi
+ *               (di default ricavata da `Comp`, vedi `bst_equivalent`).
+ */
+template <typename T, typename Comp, typename Equal = bst_equivalent<Comp>>
+class persistent_bst
+{
+    static constexpr bool derived_equal = bst_derived_equal<Comp, Equal>::value;
+
+    /**
+     * @brief Struttura che rappresenta un nodo immutabile dell'albero.
+     */
+    struct node
+    {
+        const T value;                          //< valore del nodo
+        const node *const left;                 //< puntatore al nodo figlio sinistro
+        const node *const right;                //< puntatore al nodo figlio destro
+        const unsigned char height;             //< altezza del sottoalbero radicato nel nodo
+        mutable std::atomic<unsigned int> refs; //< numero di riferimenti al nodo
+
+        /**
+         * @brief Costruttore della struttura node.
+         *
+         * @param v Il valore del nodo.
+         * @param l Il figlio sinistro, di cui il nodo prende il riferimento.
+         * @param r Il figlio destro, di cui il nodo prende il riferimento.
+         */
+        node(const T &v, const node *l, const node *r)
+            : value(v), left(l), right(r),
+              height(static_cast<unsigned char>(1 + std::max(persistent_bst::height(l), persistent_bst::height(r)))),
+              refs(1) {}
+    };
+
+    /**
+     * @brief Riferimento posseduto a un nodo: rilascia il nodo quando viene distrutto.
+     */
+    class node_ref
+    {
+        const node *_n; //< nodo riferito, oppure nullptr
+
+    public:
+        node_ref() : _n(nullptr) {}
+
+        explicit node_ref(const node *n) : _n(n) {}
+
+        node_ref(node_ref &&other) noexcept : _n(other._n)
+        {
+            other._n = nullptr;
+        }
+
+        node_ref &operator=(node_ref &&other) noexcept
+        {
+            std::swap(_n, other._n);
+            return *this;
+        }
+
+        node_ref(const node_ref &) = delete;
+        node_ref &operator=(const node_ref &) = delete;
+
+        ~node_ref()
+        {
+            persistent_bst::release(_n);
+        }
+
+        /**
+         * @brief Restituisce il nodo riferito.
+         */
+        const node *get() const
+        {
+            return _n;
+        }
+
+        /**
+         * @brief Cede il riferimento al chiamante.
+         *
+         * @return Il nodo riferito, che il chiamante dovrà rilasciare.
+         */
+        const node *take()
+        {
+            const node *n = _n;
+            _n = nullptr;
+            return n;
+        }
+    };
+
+    node_ref _root;     //< radice dell'albero
+    unsigned int _size; //< numero di nodi dell'albero
+    Comp _compare;      //< funtore per il confronto tra i valori dei nodi
+    Equal _equal;       //< funtore per l'uguaglianza tra i valori dei nodi
+
+    /**
+     * @brief Restituisce l'altezza del sottoalbero radicato in n (0 se vuoto).
+     */
+    static int height(const node *n)
+    {
+        return n == nullptr ? 0 : n->height;
+    }
+
+    /**
+     * @brief Prende un nuovo riferimento a un nodo condiviso.
+     *
+     * @param n Il nodo (anche nullo).
+     * @return Il riferimento al nodo.
+     */
+    static node_ref share(const node *n)
+    {
+        if (n != nullptr)
+            n->refs.fetch_add(1, std::memory_order_relaxed);
+        return node_ref(n);
+    }
+
+    /**
+     * @brief Rilascia un riferimento a un nodo, distruggendo i nodi non più usati.
+     *
+     * La discesa segue il figlio destro in un ciclo e il sinistro per ricorsione:
+     * la profondità resta O(log n) perché l'albero è bilanciato.
+     *
+     * @param n Il nodo (anche nullo).
+     */
+    static void release(const node *n)
+    {
+        while (n != nullptr && n->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            const node *r = n->right;
+            release(n->left);
+            delete n;
+            n = r;
+        }
+    }
+
+    /**
+     * @brief Crea un nuovo nodo con i figli specificati.
+     *
+     * @param v Il valore del nodo, copiato.
+     * @param l Il figlio sinistro.
+     * @param r Il figlio destro.
+     * @return Il riferimento al nuovo nodo.
+     *
+     * @throw Eccezione generata dall'allocazione o dalla copia del valore; i figli vengono rilasciati.
+     */
+    static node_ref make(const T &v, node_ref l, node_ref r)
+    {
+        node *n = new node(v, l.get(), r.get());
+        l.take();
+        r.take();
+        return node_ref(n);
+    }
+
+    /**
+     * @brief Crea un nodo con valore v e figli l e r, ripristinando la regola AVL con una rotazione.
+     *
+     * Le rotazioni ricreano i nodi coinvolti invece di modificarli.
+     *
+     * @param v Il valore del nodo.
+     * @param l Il figlio sinistro, con altezza al più di due maggiore di r.
+     * @param r Il figlio destro, con altezza al più di due maggiore di l.
+     * @return La radice del sottoalbero bilanciato.
+     */
+    static node_ref balance(const T &v, node_ref l, node_ref r)
+    {
+        if (height(l.get()) > height(r.get()) + 1)
+        {
+            const node *x = l.get();
+            if (height(x->left) >= height(x->right))
+                return make(x->value, share(x->left), make(v, share(x->right), std::move(r)));
+            const node *y = x->right;
+            return make(y->value, make(x->value, share(x->left), share(y->left)),
+                        make(v, share(y->right), std::move(r)));
+        }
+        if (height(r.get()) > height(l.get()) + 1)
+        {
+            const node *x = r.get();
+            if (height(x->right) >= height(x->left))
+                return make(x->value, make(v, std::move(l), share(x->left)), share(x->right));
+            const node *y = x->left;
+            return make(y->value, make(v, std::move(l), share(y->left)),
+                        make(x->value, share(y->right), share(x->right)));
+        }
+        return make(v, std::move(l), std::move(r));
+    }
+
+    /**
+     * @brief Restituisce il sottoalbero radicato in n con in più il valore specificato.
+     *
+     * @param n La radice del sottoalbero.
+     * @param value Il valore da aggiungere.
+     * @param added Posto a false se il valore è già presente (il risultato è allora nullo).
+     * @param candidate Con `derived_equal`, l'ultimo antenato non maggiore del valore: è
+     *                  l'unico che può essergli uguale e viene controllato solo in fondo.
+     * @return La radice del nuovo sottoalbero.
+     */
+    node_ref insert(const node *n, const T &value, bool &added, const node *candidate = nullptr) const
+    {
+        if (n == nullptr)
+        {
+            if constexpr (derived_equal)
+            {
+                if (candidate != nullptr && !_compare(candidate->value, value))
+                {
+                    added = false;
+                    return node_ref();
+                }
+            }
+            added = true;
+            return make(value, node_ref(), node_ref());
+        }
+        if constexpr (!derived_equal)
+        {
+            if (_equal(value, n->value))
+            {
+                added = false;
+                return node_ref();
+            }
+        }
+        if (_compare(value, n->value))
+        {
+            node_ref l = insert(n->left, value, added, candidate);
+            return added ? balance(n->value, std::move(l), share(n->right)) : node_ref();
+        }
+        node_ref r = insert(n->right, value, added, n);
+        return added ? balance(n->value, share(n->left), std::move(r)) : node_ref();
+    }
+
+    /**
+     * @brief Restituisce il sottoalbero radicato in n senza il suo valore minimo.
+     *
+     * @param n La radice del sottoalbero, non nulla.
+     * @return La radice del nuovo sottoalbero.
+     */
+    static node_ref erase_min(const node *n)
+    {
+        if (n->left == nullptr)
+            return share(n->right);
+        return balance(n->value, erase_min(n->left), share(n->right));
+    }
+
+    /**
+     * @brief Restituisce il sottoalbero radicato in n senza il valore equivalente alla chiave.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param n La radice del sottoalbero.
+     * @param key La chiave da rimuovere.
+     * @param erased Posto a false se la chiave non è presente (il risultato è allora nullo).
+     * @param target Con `derived_equal`, il nodo da rimuovere già trovato da `find_node`:
+     *               si riconosce dall'indirizzo, senza confrontare i valori.
+     * @return La radice del nuovo sottoalbero.
+     */
+    template <typename K>
+    node_ref remove(const node *n, const K &key, bool &erased, const node *target = nullptr) const
+    {
+        if (n == nullptr)
+        {
+            erased = false;
+            return node_ref();
+        }
+        if (derived_equal ? n == target : _equal(key, n->value))
+        {
+            erased = true;
+            if (n->left == nullptr)
+                return share(n->right);
+            if (n->right == nullptr)
+                return share(n->left);
+            const node *m = n->right;
+            while (m->left != nullptr)
+                m = m->left;
+            return balance(m->value, share(n->left), erase_min(n->right));
+        }
+        if (_compare(key, n->value))
+        {
+            node_ref l = remove(n->left, key, erased, target);
+            return erased ? balance(n->value, std::move(l), share(n->right)) : node_ref();
+        }
+        node_ref r = remove(n->right, key, erased, target);
+        return erased ? balance(n->value, share(n->left), std::move(r)) : node_ref();
+    }
+
+    /**
+     * @brief Cerca il nodo che contiene un valore equivalente alla chiave.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da cercare.
+     * @return Il nodo trovato, oppure nullptr.
+     */
+    template <typename K>
+    const node *find_node(const K &key) const
+    {
+        const node *curr = _root.get();
+        if constexpr (derived_equal)
+        {
+            // un solo confronto per livello, come in bst: si controlla solo l'ultimo nodo non maggiore
+            const node *candidate = nullptr;
+            while (curr != nullptr)
+            {
+                if (_compare(key, curr->value))
+                    curr = curr->left;
+                else
+                {
+                    candidate = curr;
+                    curr = curr->right;
+                }
+            }
+            if (candidate != nullptr && _compare(candidate->value, key))
+                candidate = nullptr;
+            return candidate;
+        }
+        else
+        {
+            while (curr != nullptr)
+            {
+                if (_equal(key, curr->value))
+                    return curr;
+                curr = _compare(key, curr->value) ? curr->left : curr->right;
+            }
+            return nullptr;
+        }
+    }
+
+    /**
+     * @brief Cerca un valore equivalente alla chiave.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da cercare.
+     * @return True se un valore equivalente alla chiave viene trovato, altrimenti false.
+     */
+    template <typename K>
+    bool find_key(const K &key) const
+    {
+        return find_node(key) != nullptr;
+    }
+
+    /**
+     * @brief Rimuove il valore equivalente alla chiave.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da rimuovere.
+     * @return 1 se un valore è stato rimosso, altrimenti 0.
+     */
+    template <typename K>
+    unsigned int erase_key(const K &key)
+    {
+        const node *target = nullptr;
+        if constexpr (derived_equal)
+        {
+            // prima si trova il nodo con un confronto per livello, poi lo si riconosce dall'indirizzo
+            target = find_node(key);
+            if (target == nullptr)
+                return 0;
+        }
+        bool erased = false;
+        node_ref root = remove(_root.get(), key, erased, target);
+        if (!erased)
+            return 0;
+        _root = std::move(root);
+        _size--;
+        return 1;
+    }
+
+public:
+    /**
+     * @brief Costruttore di default: albero vuoto.
+     */
+    persistent_bst() : _size(0) {}
+
+    /**
+     * @brief Copy constructor
+     *
+     * La copia condivide tutti i nodi con l'originale: costa O(1).
+     *
+     * @param other L'albero da copiare.
+     */
+    persistent_bst(const persistent_bst &other)
+        : _root(share(other._root.get())), _size(other._size), _compare(other._compare), _equal(other._equal) {}
+
+    /**
+     * @brief Move constructor
+     *
+     * @param other L'albero da cui spostare i nodi, che resta vuoto.
+     */
+    persistent_bst(persistent_bst &&other) noexcept
+        : _root(std::move(other._root)), _size(other._size), _compare(other._compare), _equal(other._equal)
+    {
+        other._size = 0;
+    }
+
+    /**
+     * @brief Operatore assegnazione
+     *
+     * Condivide i nodi di other e rilascia quelli correnti: costa O(1), più la distruzione
+     * dei nodi non più usati da nessuna versione.
+     *
+     * @param other L'albero da copiare.
+     * @return reference all'istanza corrente.
+     */
+    persistent_bst &operator=(const persistent_bst &other)
+    {
+        _root = share(other._root.get());
+        _size = other._size;
+        return *this;
+    }
+
+    /**
+     * @brief Operatore assegnazione per spostamento
+     *
+     * @param other L'albero da cui spostare i nodi, che resta vuoto.
+     * @return reference all'istanza corrente.
+     */
+    persistent_bst &operator=(persistent_bst &&other) noexcept
+    {
+        if (this != &other)
+        {
+            _root = node_ref();
+            std::swap(_root, other._root);
+            _size = other._size;
+            other._size = 0;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Costruisce un albero a partire da una sequenza di elementi.
+     *
+     * @tparam Iter Il tipo dell'iteratore.
+     * @param begin L'iteratore di inizio della sequenza.
+     * @param end L'iteratore di fine della sequenza.
+     *
+     * @throw Eccezione generata durante l'inserimento degli elementi.
+     */
+    template <typename Iter>
+    persistent_bst(Iter begin, Iter end) : _size(0)
+    {
+        for (; begin != end; ++begin)
+            add(*begin);
+    }
+
+    /**
+     * @brief Restituisce una copia immutabile dello stato corrente in O(1).
+     *
+     * Le modifiche successive all'albero non sono visibili nella copia.
+     *
+     * @return La copia dell'albero.
+     */
+    persistent_bst snapshot() const
+    {
+        return *this;
+    }
+
+    /**
+     * @brief Aggiunge un valore all'albero.
+     *
+     * Vengono creati O(log n) nodi nuovi; i nodi esistenti, eventualmente condivisi
+     * con altre copie, non vengono modificati.
+     *
+     * @param value Il valore da aggiungere all'albero.
+     * @return True se il valore è stato aggiunto, false se era già presente.
+     *
+     * @throw Eccezione generata dall'allocazione o dalla copia dei valori;
+     *        in tal caso l'albero resta invariato.
+     */
+    bool add(const T &value)
+    {
+        bool added = false;
+        node_ref root = insert(_root.get(), value, added);
+        if (!added)
+            return false;
+        _root = std::move(root);
+        _size++;
+        return true;
+    }
+
+    /**
+     * @brief Rimuove un valore dall'albero.
+     *
+     * Come `add`, crea O(log n) nodi nuovi senza modificare quelli esistenti.
+     *
+     * @param value Il valore da rimuovere.
+     * @return Il numero di valori rimossi (0 o 1).
+     *
+     * @throw Eccezione generata dall'allocazione o dalla copia dei valori;
+     *        in tal caso l'albero resta invariato.
+     */
+    unsigned int erase(const T &value)
+    {
+        return erase_key(value);
+    }
+
+    /**
+     * @brief Rimuove il valore equivalente alla chiave.
+     *
+     * Disponibile solo se `Comp` dichiara `is_transparent`.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da rimuovere.
+     * @return Il numero di valori rimossi (0 o 1).
+     */
+    template <typename K, typename C = Comp, typename = typename C::is_transparent>
+    unsigned int erase(const K &key)
+    {
+        return erase_key(key);
+    }
+
+    /**
+     * @brief Trova un valore nell'albero.
+     *
+     * @param value Il valore da cercare nell'albero.
+     * @return True se il valore viene trovato, altrimenti false.
+     */
+    bool find(const T &value) const
+    {
+        return find_key(value);
+    }
+
+    /**
+     * @brief Trova un valore a partire da una chiave di tipo diverso da `T`.
+     *
+     * Disponibile solo se `Comp` dichiara `is_transparent`.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da cercare.
+     * @return True se un valore equivalente alla chiave viene trovato, altrimenti false.
+     */
+    template <typename K, typename C = Comp, typename = typename C::is_transparent>
+    bool find(const K &key) const
+    {
+        return find_key(key);
+    }
+
+    /**
+     * @brief Restituisce la dimensione dell'albero.
+     *
+     * @return La dimensione dell'albero.
+     */
+    unsigned int size() const
+    {
+        return _size;
+    }
+
+    /**
+     * Funzione GLOBALE che implementa l'operatore di stream.
+     *
+     * @param os Lo stream di output su cui stampare i valori dei nodi.
+     * @param b L'albero da stampare.
+     * @return Lo stream di output su cui sono stati stampati i valori dei nodi.
+     */
+    friend std::ostream &operator<<(std::ostream &os, const persistent_bst &b)
+    {
+        for (const_iterator i = b.begin(), ie = b.end(); i != ie; ++i)
+            os << *i << ' ';
+        return os;
+    }
+
+    /**
+     * Classe che rappresenta un iteratore costante (in ordine) per la classe persistent_bst.
+     *
+     * I nodi non hanno il puntatore al genitore (sono condivisi tra più versioni), quindi
+     * l'iteratore tiene la pila degli antenati ancora da visitare. Resta valido finché
+     * esiste l'albero da cui è stato ottenuto.
+     */
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const T *pointer;
+        typedef const T &reference;
+
+        /**
+         * @brief Costruttore di default.
+         */
+        const_iterator() {}
+
+        /**
+         * @brief Operatore di dereferenziazione.
+         *
+         * @return Il riferimento costante all'elemento puntato dall'iteratore.
+         */
+        reference operator*() const
+        {
+            return stack.back()->value;
+        }
+
+        /**
+         * @brief Operatore di accesso ai membri.
+         *
+         * @return Il puntatore costante all'elemento puntato dall'iteratore.
+         */
+        pointer operator->() const
+        {
+            return &stack.back()->value;
+        }
+
+        /**
+         * @brief Operatore di post-incremento.
+         *
+         * @return Un iteratore costante che punta all'elemento precedente.
+         */
+        const_iterator operator++(int)
+        {
+            const_iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        /**
+         * @brief Operatore di pre-incremento.
+         *
+         * @return Un riferimento a se stesso.
+         */
+        const_iterator &operator++()
+        {
+            const node *n = stack.back();
+            stack.pop_back();
+            push_left(n->right);
+            return *this;
+        }
+
+        /**
+         * @brief Operatore di uguaglianza.
+         *
+         * @param other L'iteratore da confrontare.
+         * @return True se gli iteratori sono uguali, false altrimenti.
+         */
+        bool operator==(const const_iterator &other) const
+        {
+            if (stack.empty() || other.stack.empty())
+                return stack.empty() == other.stack.empty();
+            return stack.back() == other.stack.back();
+        }
+
+        /**
+         * @brief Operatore di disuguaglianza.
+         *
+         * @param other L'iteratore da confrontare.
+         * @return True se gli iteratori sono diversi, false altrimenti.
+         */
+        bool operator!=(const const_iterator &other) const
+        {
+            return !(other == *this);
+        }
+
+    private:
+        std::vector<const node *> stack; //< antenati non ancora visitati, in cima il nodo corrente
+
+        friend class persistent_bst;
+
+        /**
+         * @brief Costruttore privato: iteratore sul minimo del sottoalbero radicato in n.
+         *
+         * @param n La radice (nullptr per la fine).
+         */
+        explicit const_iterator(const node *n)
+        {
+            push_left(n);
+        }
+
+        /**
+         * @brief Scende lungo i figli sinistri a partire da n, impilando i nodi attraversati.
+         *
+         * @param n Il nodo di partenza (anche nullo).
+         */
+        void push_left(const node *n)
+        {
+            for (; n != nullptr; n = n->left)
+                stack.push_back(n);
+        }
+    };
+
+    /**
+     * @brief Restituisce un iteratore costante che punta all'elemento minimo dell'albero.
+     *
+     * @return Un iteratore costante che punta all'inizio dell'albero.
+     */
+    const_iterator begin() const
+    {
+        return const_iterator(_root.get());
+    }
+
+    /**
+     * @brief Restituisce un iteratore costante che punta alla fine dell'albero.
+     *
+     * @return Un iteratore costante che punta alla fine dell'albero.
+     */
+    const_iterator end() const
+    {
+        return const_iterator(nullptr);
+    }
+};
+
+/**
+ * Funzione GLOBALE che stampa a schermo i soli valori
+ * di un albero persistente che soddisfano un predicato specificato dall'utente.
+ *
+ * @tparam T Il tipo degli elementi nell'albero.
+ * @tparam Comp Il funtore di confronto per ordinare gli elementi nell'albero.
+ * @tparam Equal Il funtore di confronto per verificare l'uguaglianza tra gli elementi.
+ * @tparam P Il tipo del predicato da utilizzare per filtrare gli elementi.
+ *
+ * @param b L'albero da stampare.
+ * @param pred Il predicato da utilizzare per filtrare gli elementi.
+ */
+template <typename T, typename Comp, typename Equal, typename P>
+void printIF(const persistent_bst<T, Comp, Equal> &b, P pred)
+{
+    typename persistent_bst<T, Comp, Equal>::const_iterator i, ie;
+    for (i = b.begin(), ie = b.end(); i != ie; ++i)
+    {
+        if (pred(*i))
+        {
+            std::cout << *i << '\n';
+        }
+    }
+    std::cout.flush();
+}
+
+#endif
@@ -0,0 +1,720 @@
+#ifndef SMALL_BST_HPP
+#define SMALL_BST_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "bst.hpp"
+
+/**
+ * @brief Albero binario di ricerca ottimizzato per pochi elementi.
+ *
+ * Finché contiene al più N valori li tiene in un array ordinato dentro l'oggetto stesso,
+ * senza alcuna allocazione; la ricerca è binaria, oppure lineare e senza salti (quindi
+ * vettorizzabile) quando `T` è un tipo aritmetico. Al primo inserimento oltre N i valori
+ * passano in un `bst` e da quel momento tutte le operazioni sono delegate all'albero.
+ *
+ * L'array ricorda anche l'ordine di inserimento di ciascun valore: da esso si ricava la forma
+ * dell'albero che `bst` avrebbe costruito, così `subtree` restituisce lo stesso risultato
+ * in entrambe le modalità (con la policy `bst_avl` dopo una rimozione la forma può differire,
+ * ma il sottoalbero resta un AVL valido con gli stessi valori).
+ *
+ * L'array e l'albero occupano la stessa memoria: l'albero viene costruito solo quando
+ * i valori lasciano l'array, quindi l'oggetto non è più grande di un `bst`.
+ *
+ * @tparam T Il tipo di valore contenuto nei nodi dell'albero.
+ * @tparam Comp Il tipo di funzione di confronto per ordinare i nodi.
+ * @tparam Equal Il tipo di funzione di uguaglianza per confrontare i valori dei nodi.
+ * @tparam N Il numero massimo di valori tenuti nell'oggetto (al più 255).
+ * @tparam Balance La policy di bilanciamento dell'albero usato oltre N valori.
+ */
+template <typename T, typename Comp, typename Equal = bst_equivalent<Comp>, std::size_t N = 8,
+          typename Balance = bst_unbalanced>
+class small_bst
+{
+    static_assert(N > 0 && N < 256, "small_bst: N deve essere compreso tra 1 e 255");
+
+public:
+    typedef bst<T, Comp, Equal, Balance> tree_type;
+
+private:
+    /**
+     * @brief Valori tenuti nell'oggetto finché sono al più N.
+     */
+    struct inline_array
+    {
+        alignas(T) unsigned char values[N * sizeof(T)]; //< valori in ordine, validi i primi _count
+        unsigned char rank[N];                          //< ordine di inserimento di ciascun valore
+    };
+
+    union
+    {
+        inline_array _array; //< valido finché _inline è true
+        tree_type _tree;     //< albero usato oltre N valori, valido quando _inline è false
+    };
+    unsigned char _count; //< numero di valori nell'array
+    bool _inline;         //< true finché i valori stanno nell'array
+    Comp _compare;        //< funtore per il confronto tra i valori
+    Equal _equal;         //< funtore per l'uguaglianza tra i valori
+
+    T *data()
+    {
+        return std::launder(reinterpret_cast<T *>(_array.values));
+    }
+
+    const T *data() const
+    {
+        return std::launder(reinterpret_cast<const T *>(_array.values));
+    }
+
+    /**
+     * @brief Restituisce la posizione del primo valore dell'array non minore della chiave.
+     *
+     * Per i tipi aritmetici conta i valori minori senza salti condizionati, così il
+     * ciclo viene vettorizzato; altrimenti usa la ricerca binaria.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da cercare.
+     * @return La posizione, compresa tra 0 e _count.
+     */
+    template <typename K>
+    std::size_t lower_index(const K &key) const
+    {
+        const T *v = data();
+        if constexpr (std::is_arithmetic<T>::value && std::is_same<K, T>::value)
+        {
+            std::size_t i = 0;
+            for (std::size_t k = 0; k < _count; ++k)
+                i += _compare(v[k], key) ? 1 : 0;
+            return i;
+        }
+        else
+            return static_cast<std::size_t>(std::lower_bound(v, v + _count, key, _compare) - v);
+    }
+
+    /**
+     * @brief Cerca nell'array il valore equivalente alla chiave.
+     *
+     * @return La posizione del valore, oppure _count se non è presente.
+     */
+    template <typename K>
+    std::size_t find_index(const K &key) const
+    {
+        std::size_t i = lower_index(key);
+        return i < _count && _equal(key, data()[i]) ? i : _count;
+    }
+
+    /**
+     * @brief Costruisce l'albero che `bst` avrebbe ottenuto inserendo i valori dell'array.
+     *
+     * I valori vengono copiati nell'ordine di inserimento, quindi l'array resta invariato.
+     *
+     * @return L'albero.
+     *
+     * @throw Eccezione generata dall'allocazione o dalla copia dei valori.
+     */
+    tree_type build_tree() const
+    {
+        const T *order[N];
+        for (std::size_t k = 0; k < _count; ++k)
+            order[_array.rank[k]] = data() + k;
+        tree_type t;
+        for (std::size_t r = 0; r < _count; ++r)
+            t.add(*order[r]);
+        return t;
+    }
+
+    /**
+     * @brief Distrugge i valori dell'array.
+     */
+    void destroy_inline()
+    {
+        T *v = data();
+        for (std::size_t k = 0; k < _count; ++k)
+            v[k].~T();
+        _count = 0;
+    }
+
+    /**
+     * @brief Distrugge il contenuto corrente e torna alla modalità array, vuota.
+     */
+    void reset()
+    {
+        if (_inline)
+            destroy_inline();
+        else
+        {
+            _tree.~tree_type();
+            _count = 0;
+            _inline = true;
+        }
+    }
+
+    /**
+     * @brief Sposta i valori dall'array all'albero, che viene costruito al posto dell'array.
+     *
+     * @throw Eccezione generata dall'allocazione o dalla copia dei valori;
+     *        in tal caso l'oggetto resta invariato.
+     */
+    void spill()
+    {
+        tree_type t = build_tree();
+        destroy_inline();
+        ::new (static_cast<void *>(&_tree)) tree_type(std::move(t));
+        _inline = false;
+    }
+
+    /**
+     * @brief Inserisce un valore nell'array alla posizione i, spostando a destra i successivi.
+     *
+     * @pre _count < N e i <= _count.
+     *
+     * @throw Eccezione generata dalla costruzione del valore; in tal caso l'array resta invariato
+     *        se lo spostamento dei valori di `T` non genera eccezioni.
+     */
+    template <typename V>
+    void insert_at(std::size_t i, V &&value)
+    {
+        T *v = data();
+        if (i == _count)
+            ::new (static_cast<void *>(v + i)) T(std::forward<V>(value));
+        else
+        {
+            T tmp(std::forward<V>(value));
+            ::new (static_cast<void *>(v + _count)) T(std::move(v[_count - 1]));
+            std::move_backward(v + i, v + _count - 1, v + _count);
+            v[i] = std::move(tmp);
+            std::move_backward(_array.rank + i, _array.rank + _count, _array.rank + _count + 1);
+        }
+        _array.rank[i] = _count;
+        ++_count;
+    }
+
+    /**
+     * @brief Aggiunge un valore, passando all'albero se l'array è pieno.
+     */
+    template <typename V>
+    void insert_value(V &&value)
+    {
+        if (!_inline)
+        {
+            _tree.add(std::forward<V>(value));
+            return;
+        }
+        std::size_t i = lower_index(value);
+        if (i < _count && _equal(value, data()[i]))
+            return;
+        if (_count < N)
+            insert_at(i, std::forward<V>(value));
+        else
+        {
+            spill();
+            _tree.add(std::forward<V>(value));
+        }
+    }
+
+    /**
+     * @brief Rimuove dall'array il valore equivalente alla chiave.
+     *
+     * Segue la rimozione di `bst`: se il nodo implicito ha due figli il successore
+     * ne prende il posto, e quindi il suo ordine di inserimento. In un albero costruito per
+     * inserimento i due vicini in ordine sono l'uno discendente dell'altro, quindi il nodo ha
+     * un figlio sinistro (destro) se il predecessore (successore) è stato inserito dopo di lui.
+     *
+     * @return 1 se un valore è stato rimosso, altrimenti 0.
+     */
+    template <typename K>
+    unsigned int erase_inline(const K &key)
+    {
+        std::size_t i = find_index(key);
+        if (i == _count)
+            return 0;
+        unsigned char r = _array.rank[i];
+        bool has_left = i > 0 && _array.rank[i - 1] > r;
+        bool has_right = i + 1 < _count && _array.rank[i + 1] > r;
+        if (has_left && has_right)
+            std::swap(r, _array.rank[i + 1]);
+        T *v = data();
+        std::move(v + i + 1, v + _count, v + i);
+        std::move(_array.rank + i + 1, _array.rank + _count, _array.rank + i);
+        v[--_count].~T();
+        // r è l'ordine che sparisce: gli altri restano compatti tra 0 e _count - 1
+        for (std::size_t k = 0; k < _count; ++k)
+            if (_array.rank[k] > r)
+                --_array.rank[k];
+        return 1;
+    }
+
+    /**
+     * @brief Copia i valori di un altro albero in questo, che è vuoto e in modalità array.
+     *
+     * @throw Eccezione generata dalla copia dei valori; i valori già copiati restano nell'array.
+     */
+    void copy_from(const small_bst &other)
+    {
+        if (!other._inline)
+        {
+            ::new (static_cast<void *>(&_tree)) tree_type(other._tree);
+            _inline = false;
+            return;
+        }
+        for (; _count < other._count; ++_count)
+        {
+            ::new (static_cast<void *>(data() + _count)) T(other.data()[_count]);
+            _array.rank[_count] = other._array.rank[_count];
+        }
+    }
+
+    /**
+     * @brief Sposta i valori di un altro albero in questo, che è vuoto e in modalità array.
+     *
+     * @throw Eccezione generata dallo spostamento dei valori; i valori già spostati restano nell'array.
+     */
+    void move_from(small_bst &other)
+    {
+        if (!other._inline)
+        {
+            ::new (static_cast<void *>(&_tree)) tree_type(std::move(other._tree));
+            _inline = false;
+            return;
+        }
+        for (; _count < other._count; ++_count)
+        {
+            ::new (static_cast<void *>(data() + _count)) T(std::move(other.data()[_count]));
+            _array.rank[_count] = other._array.rank[_count];
+        }
+    }
+
+public:
+    /**
+     * @brief Costruttore di default: albero vuoto, nessuna allocazione.
+     */
+    small_bst() : _count(0), _inline(true) {}
+
+    /**
+     * @brief Costruisce un albero a partire da una sequenza di elementi.
+     *
+     * @tparam Iter Il tipo dell'iteratore.
+     * @param begin L'iteratore di inizio della sequenza.
+     * @param end L'iteratore di fine della sequenza.
+     *
+     * @throw Eccezione generata durante l'inserimento degli elementi.
+     */
+    template <typename Iter>
+    small_bst(Iter begin, Iter end) : _count(0), _inline(true)
+    {
+        try
+        {
+            for (; begin != end; ++begin)
+                add(*begin);
+        }
+        catch (...)
+        {
+            reset();
+            throw;
+        }
+    }
+
+    /**
+     * @brief Costruttore di copia.
+     *
+     * @param other L'albero da copiare.
+     *
+     * @throw Eccezione generata dalla copia dei valori.
+     */
+    small_bst(const small_bst &other) : _count(0), _inline(true), _compare(other._compare), _equal(other._equal)
+    {
+        try
+        {
+            copy_from(other);
+        }
+        catch (...)
+        {
+            destroy_inline();
+            throw;
+        }
+    }
+
+    /**
+     * @brief Costruttore di spostamento.
+     *
+     * @param other L'albero da spostare, che resta valido ma con contenuto non specificato.
+     */
+    small_bst(small_bst &&other) : _count(0), _inline(true), _compare(other._compare), _equal(other._equal)
+    {
+        try
+        {
+            move_from(other);
+        }
+        catch (...)
+        {
+            destroy_inline();
+            throw;
+        }
+    }
+
+    /**
+     * @brief Operatore di assegnamento, per copia o per spostamento.
+     *
+     * @param other L'albero da assegnare.
+     * @return Un riferimento a se stesso.
+     */
+    small_bst &operator=(small_bst other)
+    {
+        clear();
+        _compare = other._compare;
+        _equal = other._equal;
+        move_from(other);
+        return *this;
+    }
+
+    /**
+     * @brief Distruttore.
+     */
+    ~small_bst()
+    {
+        reset();
+    }
+
+    /**
+     * @brief Aggiunge un valore all'albero.
+     *
+     * Se il valore è già presente l'albero resta invariato.
+     *
+     * @param value Il valore da aggiungere all'albero.
+     *
+     * @throw Eccezione generata dall'allocazione o dalla copia del valore.
+     */
+    void add(const T &value)
+    {
+        insert_value(value);
+    }
+
+    /**
+     * @brief Aggiunge un valore all'albero spostandolo.
+     *
+     * @param value Il valore da aggiungere all'albero.
+     *
+     * @throw Eccezione generata dall'allocazione o dallo spostamento del valore.
+     */
+    void add(T &&value)
+    {
+        insert_value(std::move(value));
+    }
+
+    /**
+     * @brief Rimuove un valore dall'albero.
+     *
+     * L'albero non torna nella modalità array anche se i valori rimasti ci starebbero.
+     *
+     * @param value Il valore da rimuovere.
+     * @return Il numero di valori rimossi (0 o 1).
+     */
+    unsigned int erase(const T &value)
+    {
+        return _inline ? erase_inline(value) : _tree.erase(value);
+    }
+
+    /**
+     * @brief Rimuove il valore equivalente alla chiave.
+     *
+     * Disponibile solo se `Comp` dichiara `is_transparent`.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da rimuovere.
+     * @return Il numero di valori rimossi (0 o 1).
+     */
+    template <typename K, typename C = Comp, typename = typename C::is_transparent>
+    unsigned int erase(const K &key)
+    {
+        return _inline ? erase_inline(key) : _tree.erase(key);
+    }
+
+    /**
+     * @brief Trova un valore nell'albero.
+     *
+     * @param value Il valore da cercare nell'albero.
+     * @return True se il valore viene trovato, altrimenti false.
+     */
+    bool find(const T &value) const
+    {
+        return _inline ? find_index(value) != _count : _tree.find(value);
+    }
+
+    /**
+     * @brief Trova un valore a partire da una chiave di tipo diverso da `T`.
+     *
+     * Disponibile solo se `Comp` dichiara `is_transparent`.
+     *
+     * @tparam K Il tipo della chiave.
+     * @param key La chiave da cercare.
+     * @return True se un valore equivalente alla chiave viene trovato, altrimenti false.
+     */
+    template <typename K, typename C = Comp, typename = typename C::is_transparent>
+    bool find(const K &key) const
+    {
+        return _inline ? find_index(key) != _count : _tree.find(key);
+    }
+
+    /**
+     * @brief Restituisce la dimensione dell'albero.
+     *
+     * @return La dimensione dell'albero.
+     */
+    unsigned int size() const
+    {
+        return _inline ? static_cast<unsigned int>(_count) : _tree.size();
+    }
+
+    /**
+     * @brief Indica se i valori stanno ancora nell'array interno.
+     *
+     * @return True se nessun nodo è stato allocato.
+     */
+    bool is_inline() const
+    {
+        return _inline;
+    }
+
+    /**
+     * @brief Svuota l'albero e torna alla modalità array.
+     */
+    void clear()
+    {
+        reset();
+    }
+
+    /**
+     * @brief Crea un nuovo albero che rappresenta il sottoalbero con radice nel valore specificato.
+     *
+     * In modalità array l'albero viene prima ricostruito dai valori nell'ordine di inserimento.
+     *
+     * @param value Il valore da cercare nell'albero.
+     * @return Il sottoalbero copiato, vuoto se il valore non viene trovato.
+     *
+     * @throw Eccezione generata dall'allocazione o dalla copia dei valori.
+     */
+    tree_type subtree(const T &value)
+    {
+        if (!_inline)
+            return _tree.subtree(value);
+        if (find_index(value) == _count)
+            return tree_type();
+        return build_tree().subtree(value);
+    }
+
+    /**
+     * Funzione GLOBALE che implementa l'operatore di stream.
+     *
+     * @param os Lo stream di output su cui stampare i valori dei nodi.
+     * @param b L'albero da stampare.
+     * @return Lo stream di output su cui sono stati stampati i valori dei nodi.
+     */
+    friend std::ostream &operator<<(std::ostream &os, const small_bst &b)
+    {
+        return write_buffered(os, b.begin(), b.end(), [](const T &)
+                              { return true; });
+    }
+
+    /**
+     * Classe che rappresenta un iteratore costante (in ordine, in entrambe le direzioni)
+     * per la classe small_bst.
+     *
+     * In modalità array è un puntatore nell'array, altrimenti un iteratore di `bst`.
+     * Qualunque modifica dell'albero in modalità array lo invalida.
+     */
+    class const_iterator
+    {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const T *pointer;
+        typedef const T &reference;
+
+        /**
+         * @brief Costruttore di default.
+         */
+        const_iterator() : p(nullptr) {}
+
+        /**
+         * @brief Operatore di dereferenziazione.
+         *
+         * @return Il riferimento costante all'elemento puntato dall'iteratore.
+         */
+        reference operator*() const
+        {
+            return p != nullptr ? *p : *it;
+        }
+
+        /**
+         * @brief Operatore di accesso ai membri.
+         *
+         * @return Il puntatore costante all'elemento puntato dall'iteratore.
+         */
+        pointer operator->() const
+        {
+            return &**this;
+        }
+
+        /**
+         * @brief Operatore di post-incremento.
+         *
+         * @return Un iteratore costante che punta all'elemento precedente.
+         */
+        const_iterator operator++(int)
+        {
+            const_iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        /**
+         * @brief Operatore di pre-incremento.
+         *
+         * @return Un riferimento a se stesso.
+         */
+        const_iterator &operator++()
+        {
+            if (p != nullptr)
+                ++p;
+            else
+                ++it;
+            return *this;
+        }
+
+        /**
+         * @brief Operatore di post-decremento.
+         *
+         * @return Un iteratore costante che punta all'elemento successivo.
+         */
+        const_iterator operator--(int)
+        {
+            const_iterator tmp(*this);
+            --*this;
+            return tmp;
+        }
+
+        /**
+         * @brief Operatore di pre-decremento.
+         *
+         * @return Un riferimento a se stesso.
+         */
+        const_iterator &operator--()
+        {
+            if (p != nullptr)
+                --p;
+            else
+                --it;
+            return *this;
+        }
+
+        /**
+         * @brief Operatore di uguaglianza.
+         *
+         * @param other L'iteratore da confrontare.
+         * @return True se gli iteratori sono uguali, false altrimenti.
+         */
+        bool operator==(const const_iterator &other) const
+        {
+            return p == other.p && (p != nullptr || it == other.it);
+        }
+
+        /**
+         * @brief Operatore di disuguaglianza.
+         *
+         * @param other L'iteratore da confrontare.
+         * @return True se gli iteratori sono diversi, false altrimenti.
+         */
+        bool operator!=(const const_iterator &other) const
+        {
+            return !(other == *this);
+        }
+
+    private:
+        const T *p;                                //< posizione nell'array (nullptr in modalità albero)
+        typename tree_type::const_iterator it;     //< posizione nell'albero
+
+        friend class small_bst;
+
+        /**
+         * @brief Costruttore privato per la modalità array.
+         */
+        explicit const_iterator(const T *p) : p(p) {}
+
+        /**
+         * @brief Costruttore privato per la modalità albero.
+         */
+        explicit const_iterator(typename tree_type::const_iterator it) : p(nullptr), it(it) {}
+    };
+
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    /**
+     * @brief Restituisce un iteratore costante che punta all'elemento minimo dell'albero.
+     *
+     * @return Un iteratore costante che punta all'inizio dell'albero.
+     */
+    const_iterator begin() const
+    {
+        return _inline ? const_iterator(data()) : const_iterator(_tree.begin());
+    }
+
+    /**
+     * @brief Restituisce un iteratore costante che punta alla fine dell'albero.
+     *
+     * @return Un iteratore costante che punta alla fine dell'albero.
+     */
+    const_iterator end() const
+    {
+        return _inline ? const_iterator(data() + _count) : const_iterator(_tree.end());
+    }
+
+    /**
+     * @brief Restituisce un iteratore inverso che punta all'elemento massimo.
+     *
+     * @return Un iteratore inverso costante.
+     */
+    const_reverse_iterator rbegin() const
+    {
+        return const_reverse_iterator(end());
+    }
+
+    /**
+     * @brief Restituisce un iteratore inverso alla fine della visita decrescente.
+     *
+     * @return Un iteratore inverso costante.
+     */
+    const_reverse_iterator rend() const
+    {
+        return const_reverse_iterator(begin());
+    }
+};
+
+/**
+ * Funzione GLOBALE che stampa a schermo i soli valori
+ * di un albero piccolo che soddisfano un predicato specificato dall'utente.
+ *
+ * @tparam T Il tipo degli elementi nell'albero.
+ * @tparam Comp Il funtore di confronto per ordinare gli elementi nell'albero.
+ * @tparam Equal Il funtore di confronto per verificare l'uguaglianza tra gli elementi.
+ * @tparam N Il numero massimo di valori tenuti nell'oggetto.
+ * @tparam Balance La policy di bilanciamento dell'albero.
+ * @tparam P Il tipo del predicato da utilizzare per filtrare gli elementi.
+ *
+ * @param b L'albero da stampare.
+ * @param pred Il predicato da utilizzare per filtrare gli elementi.
+ */
+template <typename T, typename Comp, typename Equal, std::size_t N, typename Balance, typename P>
+void printIF(const small_bst<T, Comp, Equal, N, Balance> &b, P pred)
+{
+    write_buffered(std::cout, b.begin(), b.end(), pred, '\n');
+    std::cout.flush();
+}
+
+#endif